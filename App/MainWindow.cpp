@@ -43,16 +43,16 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     dualValue->setValue2Range(min, max);
 
 
-    // Make connections
-    connect(doubleSlider1, SIGNAL(valueChanged(double)), powerSlider1, SLOT(setValue(double)));
-    connect(powerSlider1, SIGNAL(valueChanged(double)), exploratorySlider1, SLOT(setValue(double)));
-    connect(exploratorySlider1, SIGNAL(valueChanged(double)), dualValue, SLOT(setValue1(double)));
-    connect(dualValue, SIGNAL(value1Changed(double)), doubleSlider1, SLOT(setValue(double)));
-    
-    connect(doubleSlider2, SIGNAL(valueChanged(double)), powerSlider2, SLOT(setValue(double)));
-    connect(powerSlider2, SIGNAL(valueChanged(double)), exploratorySlider2, SLOT(setValue(double)));
-    connect(exploratorySlider2, SIGNAL(valueChanged(double)), dualValue, SLOT(setValue2(double)));
-    connect(dualValue, SIGNAL(value2Changed(double)), doubleSlider2, SLOT(setValue(double)));
+    // Make connections, passing interaction phases along, so each widget
+    // gives one final update when a drag on any of them ends.  The dual
+    // value is connected back to the double sliders automatically.
+    connect(doubleSlider1, SIGNAL(valueUpdated(double, QInteractionPhase, qint64)), powerSlider1, SLOT(setValue(double, QInteractionPhase)));
+    connect(powerSlider1, SIGNAL(valueUpdated(double, QInteractionPhase, qint64)), exploratorySlider1, SLOT(setValue(double, QInteractionPhase)));
+    connect(exploratorySlider1, SIGNAL(valueUpdated(double, QInteractionPhase, qint64)), dualValue, SLOT(setValue1(double, QInteractionPhase)));
+
+    connect(doubleSlider2, SIGNAL(valueUpdated(double, QInteractionPhase, qint64)), powerSlider2, SLOT(setValue(double, QInteractionPhase)));
+    connect(powerSlider2, SIGNAL(valueUpdated(double, QInteractionPhase, qint64)), exploratorySlider2, SLOT(setValue(double, QInteractionPhase)));
+    connect(exploratorySlider2, SIGNAL(valueUpdated(double, QInteractionPhase, qint64)), dualValue, SLOT(setValue2(double, QInteractionPhase)));
 
 
     // Set the value
@@ -105,4 +105,9 @@ void MainWindow::on_checkBox_toggled(bool checked) {
         disconnect(exploratorySlider1, SIGNAL(pivotValueChanged(double)), exploratorySlider2, SLOT(setPivotValue(double)));
         disconnect(exploratorySlider2, SIGNAL(pivotValueChanged(double)), exploratorySlider1, SLOT(setPivotValue(double)));
     }
+}
+
+void MainWindow::on_dualValue_valuesUpdated(QPointF values, QInteractionPhase phase, qint64) {
+    doubleSlider1->setValue(values.x(), phase);
+    doubleSlider2->setValue(values.y(), phase);
 }
\ No newline at end of file
@@ -19,6 +19,8 @@
 
 #include "ui_MainWindow.h"
 
+#include "QInteractionPhase.h"
+
 class QDoubleSlider;
 
 
@@ -41,6 +43,7 @@ public slots:
 
     // Widget events
     virtual void on_checkBox_toggled(bool checked);
+    virtual void on_dualValue_valuesUpdated(QPointF values, QInteractionPhase phase, qint64 sequence);
 
 protected:
     // Double sliders to combine sliders and spin boxes
@@ -0,0 +1,143 @@
+/*=========================================================================
+
+  Name:        QFastMathBenchmark.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Measures the error and speed of qFastPow() against libm pow,
+               as used by QPowExact.
+
+               Usage:
+
+                   QFastMathBenchmark [repetitions]
+
+               The error is the maximum relative error for x in (0, 1],
+               including denormals, and exponents 1.1^k for k in
+               [-60, 60], the range reachable through 60 *1.1 or /1.1
+               steps.  Results below DBL_MIN are skipped, as their
+               relative error is meaningless.
+
+               The time is per call, over a 2^16-element loop repeated
+               the given number of times, default 200, so compile with
+               the same flags as the library to get representative
+               numbers.
+
+=========================================================================*/
+
+
+#include "QFastMath.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+// Elements per timed loop
+static const int loopSize = 1 << 16;
+
+
+// Maximum relative error over the given inputs
+double maximumError(const QVector<double>& xs, const QVector<double>& exponents)
+{
+    double error = 0.0;
+
+    for (int j = 0; j < exponents.size(); j++) {
+        for (int i = 0; i < xs.size(); i++) {
+            double exact = qPow(xs[i], exponents[j]);
+
+            if (exact < DBL_MIN) {
+                continue;
+            }
+
+            error = qMax(error, qAbs(qFastPow(xs[i], exponents[j]) - exact) / exact);
+        }
+    }
+
+    return error;
+}
+
+
+// Nanoseconds per call of qPow with the given accuracy, and the sum of the
+// results so the loop is not optimized away
+double timePow(const QVector<double>& xs, double e, QPowAccuracy accuracy, int repetitions, double* sum)
+{
+    QVector<double> ys(xs.size());
+
+    const double* x = xs.constData();
+    double* y = ys.data();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int r = 0; r < repetitions; r++) {
+        if (accuracy == QPowFast) {
+            for (int i = 0; i < loopSize; i++) {
+                y[i] = qFastPow(x[i], e);
+            }
+        }
+        else {
+            for (int i = 0; i < loopSize; i++) {
+                y[i] = qPow(x[i], e);
+            }
+        }
+
+        *sum += y[r % loopSize];
+    }
+
+    return (double)timer.nsecsElapsed() / ((double)repetitions * loopSize);
+}
+
+
+int main(int argc, char** argv) {
+    int repetitions = argc > 1 ? qMax(atoi(argv[1]), 1) : 200;
+
+    // Exponents reachable from 1 through the sliders' *1.1 and /1.1 steps
+    QVector<double> exponents;
+
+    for (int k = -60; k <= 60; k++) {
+        exponents.append(qPow(1.1, k));
+    }
+
+    // Normal x, spread evenly in value and in log2
+    QVector<double> normals;
+
+    for (int i = 1; i <= 10000; i++) {
+        normals.append(i / 10000.0);
+        normals.append(qPow(2.0, -1022.0 * i / 10000.0));
+    }
+
+    // Denormal x
+    QVector<double> denormals;
+
+    for (int i = 1; i <= 10000; i++) {
+        denormals.append(DBL_MIN * i / 10000.0);
+    }
+
+    printf("Maximum relative error, normal x:    %.3g\n", maximumError(normals, exponents));
+    printf("Maximum relative error, denormal x:  %.3g\n", maximumError(denormals, exponents));
+
+
+    // Timing, on x in (0, 1]
+    QVector<double> xs(loopSize);
+
+    for (int i = 0; i < loopSize; i++) {
+        xs[i] = (i + 1.0) / loopSize;
+    }
+
+    double sum = 0.0;
+
+    double exact = timePow(xs, 2.5, QPowExact, repetitions, &sum);
+    double fast = timePow(xs, 2.5, QPowFast, repetitions, &sum);
+
+    printf("QPowExact:  %.2f ns per call\n", exact);
+    printf("QPowFast:   %.2f ns per call\n", fast);
+    printf("Speedup:    %.2fx\n", exact / fast);
+
+    // Keeps the results live
+    return sum == 0.0 ? 1 : 0;
+}
\ No newline at end of file
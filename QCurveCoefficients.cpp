@@ -0,0 +1,141 @@
+/*=========================================================================
+
+  Name:        QCurveCoefficients.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: The curve of a power or exploratory slider as a small,
+               versioned block of floats for shaders.
+
+=========================================================================*/
+
+
+#include "QCurveCoefficients.h"
+
+#include <cmath>
+
+
+// Offsets into the block
+enum {
+    VersionOffset = 0,
+    MinimumOffset = 1,
+    MaximumOffset = 2,
+    SplitOffset = 3,
+    LeftOffset = 4,
+    RightOffset = 8,
+    ExponentOffset = 12,
+    InvertOffset = 13
+};
+
+
+QCurveCoefficients::QCurveCoefficients()
+{
+    for (int i = 0; i < Size; i++) {
+        data[i] = 0.0f;
+    }
+
+    data[VersionOffset] = Version;
+    data[MinimumOffset] = 0.0f;
+    data[MaximumOffset] = 1.0f;
+    data[SplitOffset] = 1.0f;
+    data[ExponentOffset] = 1.0f;
+
+    setPiece(0, QPointF(0.0, 0.0), QPointF(1.0, 1.0));
+    setPiece(1, QPointF(0.0, 0.0), QPointF(1.0, 1.0));
+}
+
+QCurveCoefficients::QCurveCoefficients(const QPowerMapping& mapping, double minimum, double maximum)
+{
+    *this = QCurveCoefficients();
+
+    data[MinimumOffset] = minimum;
+    data[MaximumOffset] = maximum;
+
+    // One piece, anchored at 0, or at 1 when flipped, as in QPowerMapping::yFromX()
+    double e = mapping.getExponent();
+    bool invert = e < 1.0;
+
+    QPointF anchor = invert ? QPointF(1.0, 1.0) : QPointF(0.0, 0.0);
+    QPointF end = invert ? QPointF(0.0, 0.0) : QPointF(1.0, 1.0);
+
+    setPiece(0, anchor, end);
+    setPiece(1, anchor, end);
+
+    data[ExponentOffset] = invert ? 1.0 / e : e;
+    data[InvertOffset] = invert ? 1.0f : 0.0f;
+}
+
+QCurveCoefficients::QCurveCoefficients(const QExploratoryMapping& mapping, double minimum, double maximum)
+{
+    *this = QCurveCoefficients();
+
+    data[MinimumOffset] = minimum;
+    data[MaximumOffset] = maximum;
+
+    // Two pieces meeting at the pivot, as in QExploratoryMapping::yFromX()
+    double e = mapping.getExponent();
+    bool invert = e < 1.0;
+
+    QPointF p1 = mapping.getCurvePoint1();
+    QPointF p2 = mapping.getCurvePoint2();
+    QPointF p3 = mapping.getCurvePoint3();
+
+    data[SplitOffset] = p2.x();
+
+    if (invert) {
+        setPiece(0, p1, p2);
+        setPiece(1, p3, p2);
+    }
+    else {
+        setPiece(0, p2, p1);
+        setPiece(1, p2, p3);
+    }
+
+    data[ExponentOffset] = invert ? 1.0 / e : e;
+    data[InvertOffset] = invert ? 1.0f : 0.0f;
+}
+
+
+const float* QCurveCoefficients::constData() const
+{
+    return data;
+}
+
+
+float QCurveCoefficients::evaluate(float x) const
+{
+    // Step for step as glslSource(), in single precision
+    const float* p = x > data[SplitOffset] ? data + RightOffset : data + LeftOffset;
+
+    float d = std::fabs((p[0] - x) / (p[2] - p[0]));
+    float y = p[1] + std::pow(d, data[ExponentOffset]) * (p[3] - p[1]);
+
+    return data[MinimumOffset] + y * (data[MaximumOffset] - data[MinimumOffset]);
+}
+
+
+QString QCurveCoefficients::glslSource()
+{
+    return QString(
+        "// QScientific curve, coefficient block version %1\n"
+        "float qscientificCurve(vec4 c[4], float x)\n"
+        "{\n"
+        "    vec4 p = x > c[0].w ? c[2] : c[1];\n"
+        "    float d = abs((p.x - x) / (p.z - p.x));\n"
+        "    float y = p.y + pow(d, c[3].x) * (p.w - p.y);\n"
+        "    return c[0].y + y * (c[0].z - c[0].y);\n"
+        "}\n").arg((int)Version);
+}
+
+
+void QCurveCoefficients::setPiece(int piece, const QPointF& anchor, const QPointF& end)
+{
+    float* p = data + (piece == 0 ? LeftOffset : RightOffset);
+
+    p[0] = anchor.x();
+    p[1] = anchor.y();
+    p[2] = end.x();
+    p[3] = end.y();
+}
\ No newline at end of file
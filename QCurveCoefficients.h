@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Name:        QCurveCoefficients.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: The curve of a power or exploratory slider as a small,
+               versioned block of floats, so a shader can evaluate exactly
+               the curve the user set instead of sampling a lookup table.
+
+               Both curves are one or two power function pieces, split at
+               a slider position.  Each piece runs from an anchor point,
+               where it is flat when the exponent is greater than 1, to a
+               end point, and gives
+
+                   y = anchor.y + |(x - anchor.x) / (end.x - anchor.x)|^e
+                                  * (end.y - anchor.y)
+
+               in normalized coordinates, which is then scaled to the
+               range.  The block is four vec4s, e.g. for a uniform
+               vec4 array:
+
+                   [0]  version, minimum, maximum, split x
+                   [1]  left piece anchor x, anchor y, end x, end y
+                   [2]  right piece anchor x, anchor y, end x, end y
+                   [3]  exponent, invert, 0, 0
+
+               where invert is 1 if the slider exponent is less than 1,
+               in which case the pieces are anchored at the ends instead
+               and the exponent is its reciprocal.
+
+               glslSource() returns a GLSL function that evaluates the
+               block, and evaluate() does the same on the CPU in single
+               precision, as a reference for the shader.
+
+=========================================================================*/
+
+
+#ifndef QCURVECOEFFICIENTS_H
+#define QCURVECOEFFICIENTS_H
+
+
+#include "QNonlinearMapping.h"
+
+#include <QString>
+
+
+class QCurveCoefficients
+{
+public:
+    enum {
+        Version = 1,    // Increased whenever the layout changes
+        Size = 16       // Number of floats
+    };
+
+    // An identity curve on [0, 1]
+    QCurveCoefficients();
+
+    QCurveCoefficients(const QPowerMapping& mapping, double minimum, double maximum);
+    QCurveCoefficients(const QExploratoryMapping& mapping, double minimum, double maximum);
+
+    const float* constData() const;
+
+    // Data value for the slider position x in [0, 1]
+    float evaluate(float x) const;
+
+    // GLSL 1.20 function float qscientificCurve(vec4 c[4], float x) that
+    // evaluates the block
+    static QString glslSource();
+
+protected:
+    float data[Size];
+
+    // Internal methods
+    void setPiece(int piece, const QPointF& anchor, const QPointF& end);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,388 @@
+/*=========================================================================
+
+  Name:        QDataIndex.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A sorted copy of a data set, so the number of samples below,
+               above or inside a value or window can be counted with binary
+               searches at drag rate, instead of scanning the data.
+
+=========================================================================*/
+
+
+#include "QDataIndex.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+
+// A sample and its index, for sorting with the permutation
+struct QDataIndexEntry {
+    double value;
+    quint32 index;
+
+    bool operator<(const QDataIndexEntry& other) const {
+        return value < other.value;
+    }
+};
+
+
+// Sorted runs [begin, middle) and [middle, end) to merge, or [begin, end) to
+// sort, and whether to remove duplicates afterwards, which moves the end
+template <class T>
+struct QDataIndexRange {
+    T* begin;
+    T* middle;
+    T* end;
+    bool distinct;
+};
+
+template <class T>
+static bool equivalent(const T& a, const T& b)
+{
+    return !(a < b) && !(b < a);
+}
+
+template <class T>
+static void sortRange(QDataIndexRange<T>& range)
+{
+    std::sort(range.begin, range.end);
+
+    if (range.distinct) {
+        range.end = std::unique(range.begin, range.end, equivalent<T>);
+    }
+}
+
+template <class T>
+static void mergeRange(QDataIndexRange<T>& range)
+{
+    std::inplace_merge(range.begin, range.middle, range.end);
+
+    if (range.distinct) {
+        range.end = std::unique(range.begin, range.end, equivalent<T>);
+    }
+}
+
+// Closes the gaps left between runs by removing duplicates
+template <class T>
+static void compactRanges(QVector<QDataIndexRange<T> >& ranges)
+{
+    for (int i = 1; i < ranges.size(); i++) {
+        T* begin = ranges[i - 1].end;
+
+        if (ranges[i].begin != begin) {
+            ranges[i].end = std::copy(ranges[i].begin, ranges[i].end, begin);
+            ranges[i].begin = begin;
+        }
+    }
+}
+
+
+// Sorts in parallel, returning the number of elements kept
+template <class T>
+static qint64 parallelSort(T* data, qint64 n, bool distinct)
+{
+    // Not worth splitting small data
+    int chunks = n < (1 << 16) ? 1 : qMax(QThread::idealThreadCount(), 1);
+
+    // Sort chunks in parallel
+    QVector<QDataIndexRange<T> > ranges;
+
+    for (int i = 0; i < chunks; i++) {
+        QDataIndexRange<T> range;
+        range.begin = data + n * i / chunks;
+        range.middle = range.begin;
+        range.end = data + n * (i + 1) / chunks;
+        range.distinct = distinct;
+
+        ranges.append(range);
+    }
+
+    QtConcurrent::blockingMap(ranges, &sortRange<T>);
+
+    if (distinct) {
+        compactRanges(ranges);
+    }
+
+    // Merge neighboring runs in parallel until one is left
+    while (ranges.size() > 1) {
+        QVector<QDataIndexRange<T> > merges;
+
+        for (int i = 0; i + 1 < ranges.size(); i += 2) {
+            QDataIndexRange<T> range;
+            range.begin = ranges[i].begin;
+            range.middle = ranges[i].end;
+            range.end = ranges[i + 1].end;
+            range.distinct = distinct;
+
+            merges.append(range);
+        }
+
+        QtConcurrent::blockingMap(merges, &mergeRange<T>);
+
+        // An odd run out waits for the next round
+        if (ranges.size() % 2 == 1) {
+            merges.append(ranges.last());
+        }
+
+        if (distinct) {
+            compactRanges(merges);
+        }
+
+        ranges = merges;
+    }
+
+    return ranges.isEmpty() ? 0 : ranges.last().end - data;
+}
+
+
+QDataIndex::QDataIndex()
+{
+}
+
+
+void QDataIndex::clear()
+{
+    std::vector<double>().swap(sorted);
+    std::vector<quint32>().swap(permutation);
+
+    histogramCounts.clear();
+}
+
+
+qint64 QDataIndex::size() const
+{
+    return sorted.size();
+}
+
+bool QDataIndex::isEmpty() const
+{
+    return sorted.empty();
+}
+
+
+qint64 QDataIndex::countBelow(double v) const
+{
+    return std::lower_bound(sorted.begin(), sorted.end(), v) - sorted.begin();
+}
+
+qint64 QDataIndex::countAbove(double v) const
+{
+    return sorted.end() - std::upper_bound(sorted.begin(), sorted.end(), v);
+}
+
+qint64 QDataIndex::countInside(double min, double max) const
+{
+    if (max < min) {
+        return 0;
+    }
+
+    return std::upper_bound(sorted.begin(), sorted.end(), max) - std::lower_bound(sorted.begin(), sorted.end(), min);
+}
+
+
+double QDataIndex::getMinimum() const
+{
+    return sorted.empty() ? 0.0 : sorted.front();
+}
+
+double QDataIndex::getMaximum() const
+{
+    return sorted.empty() ? 0.0 : sorted.back();
+}
+
+
+double QDataIndex::quantile(double q) const
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+
+    qint64 i = qRound64(qBound(0.0, q, 1.0) * (sorted.size() - 1));
+
+    return sorted[i];
+}
+
+
+double QDataIndex::nearest(double v, double min, double max) const
+{
+    std::vector<double>::const_iterator first = std::lower_bound(sorted.begin(), sorted.end(), min);
+    std::vector<double>::const_iterator last = std::upper_bound(first, sorted.end(), max);
+
+    if (first == last) {
+        return v;
+    }
+
+    // Closest of the samples either side of v
+    std::vector<double>::const_iterator it = std::lower_bound(first, last, v);
+
+    if (it == last) {
+        return *(it - 1);
+    }
+
+    if (it != first && v - *(it - 1) <= *it - v) {
+        return *(it - 1);
+    }
+
+    return *it;
+}
+
+
+QVector<qint64> QDataIndex::histogram(int bins) const
+{
+    bins = qMax(bins, 1);
+
+    QMutexLocker locker(&histogramMutex);
+
+    if (histogramCounts.size() == bins) {
+        return histogramCounts;
+    }
+
+    histogramCounts.fill(0, bins);
+
+    if (sorted.empty()) {
+        return histogramCounts;
+    }
+
+    double min = sorted.front();
+    double width = (sorted.back() - min) / bins;
+
+    // Samples below each bin's upper edge, with the last bin closed
+    qint64 below = 0;
+
+    for (int i = 0; i < bins; i++) {
+        qint64 next = i == bins - 1 ? sorted.size() : countBelow(min + (i + 1) * width);
+
+        histogramCounts[i] = next - below;
+        below = next;
+    }
+
+    return histogramCounts;
+}
+
+
+QVector<double> QDataIndex::otsuThresholds(int classes, int bins) const
+{
+    QVector<double> thresholds;
+
+    QVector<qint64> counts = histogram(bins);
+
+    bins = counts.size();
+    classes = qBound(1, classes, bins);
+
+    if (sorted.empty() || classes == 1) {
+        return thresholds;
+    }
+
+    // Cumulative counts and sums of bin indices, so class moments are differences
+    QVector<double> w(bins + 1, 0.0);
+    QVector<double> s(bins + 1, 0.0);
+
+    for (int i = 0; i < bins; i++) {
+        w[i + 1] = w[i] + counts[i];
+        s[i + 1] = s[i] + counts[i] * (i + 0.5);
+    }
+
+    // Least within-class variance is most between-class variance, the sum over
+    // classes of s^2 / w.  best[k][j] is the most for k + 1 classes over the
+    // first j bins, and split[k][j] where the last of those classes starts.
+    QVector<QVector<double> > best(classes, QVector<double>(bins + 1, -1.0));
+    QVector<QVector<int> > split(classes, QVector<int>(bins + 1, 0));
+
+    for (int j = 1; j <= bins; j++) {
+        best[0][j] = w[j] > 0.0 ? s[j] * s[j] / w[j] : 0.0;
+    }
+
+    for (int k = 1; k < classes; k++) {
+        for (int j = k + 1; j <= bins; j++) {
+            for (int i = k; i < j; i++) {
+                double dw = w[j] - w[i];
+                double ds = s[j] - s[i];
+                double v = best[k - 1][i] + (dw > 0.0 ? ds * ds / dw : 0.0);
+
+                if (v > best[k][j]) {
+                    best[k][j] = v;
+                    split[k][j] = i;
+                }
+            }
+        }
+    }
+
+    // Walk back through the splits, converting bin edges to values
+    double min = sorted.front();
+    double width = (sorted.back() - min) / bins;
+
+    thresholds.resize(classes - 1);
+
+    int j = bins;
+
+    for (int k = classes - 1; k > 0; k--) {
+        j = split[k][j];
+
+        thresholds[k - 1] = min + j * width;
+    }
+
+    return thresholds;
+}
+
+
+const std::vector<double>& QDataIndex::getSortedData() const
+{
+    return sorted;
+}
+
+
+bool QDataIndex::hasPermutation() const
+{
+    return !permutation.empty();
+}
+
+const std::vector<quint32>& QDataIndex::getPermutation() const
+{
+    return permutation;
+}
+
+
+void QDataIndex::sortData(bool distinct)
+{
+    histogramCounts.clear();
+
+    qint64 n = sorted.size();
+
+    if (n == 0) {
+        return;
+    }
+
+    if (permutation.empty()) {
+        n = parallelSort(&sorted[0], n, distinct);
+
+        // Release the space duplicates took
+        if (n < (qint64)sorted.size()) {
+            std::vector<double>(sorted.begin(), sorted.begin() + n).swap(sorted);
+        }
+
+        return;
+    }
+
+    // Sort values and indices together
+    std::vector<QDataIndexEntry> entries(n);
+
+    for (qint64 i = 0; i < n; i++) {
+        entries[i].value = sorted[i];
+        entries[i].index = permutation[i];
+    }
+
+    parallelSort(&entries[0], n, false);
+
+    for (qint64 i = 0; i < n; i++) {
+        sorted[i] = entries[i].value;
+        permutation[i] = entries[i].index;
+    }
+}
\ No newline at end of file
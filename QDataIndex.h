@@ -0,0 +1,146 @@
+/*=========================================================================
+
+  Name:        QDataIndex.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A sorted copy of a data set, so the number of samples below,
+               above or inside a value or window can be counted with binary
+               searches at drag rate, instead of scanning the data.
+
+               The copy is sorted once, in parallel, by setData().  NaN
+               samples are dropped.  Samples are kept as doubles, at 8
+               bytes each, so integers up to 2^53 and float or double data
+               are held exactly and counts and nearest values are exact.
+               Optionally the permutation from sorted order back to sample
+               indices is kept as well, e.g. for QThresholdMask, which
+               limits the data to 2^32 samples.
+
+               setDistinctData() keeps each value once instead, e.g. for
+               snapping sliders to the values present in labelled data.
+
+=========================================================================*/
+
+
+#ifndef QDATAINDEX_H
+#define QDATAINDEX_H
+
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QVector>
+
+#include <vector>
+
+
+class QDataIndex
+{
+public:
+    QDataIndex();
+
+    // Copies and sorts the data, optionally keeping the permutation
+    template <class T>
+    void setData(const T* data, qint64 n, bool keepPermutation = false)
+    {
+        // Permutation entries are 32-bit sample indices
+        Q_ASSERT(!keepPermutation || n <= Q_INT64_C(0xffffffff));
+
+        sorted.clear();
+        sorted.reserve(n);
+
+        permutation.clear();
+
+        if (keepPermutation) {
+            permutation.reserve(n);
+        }
+
+        for (qint64 i = 0; i < n; i++) {
+            double v = (double)data[i];
+
+            if (v == v) {
+                sorted.push_back(v);
+
+                if (keepPermutation) {
+                    permutation.push_back((quint32)i);
+                }
+            }
+        }
+
+        sortData();
+    }
+
+    // Copies the distinct values of the data and sorts them
+    template <class T>
+    void setDistinctData(const T* data, qint64 n)
+    {
+        sorted.clear();
+        sorted.reserve(n);
+
+        permutation.clear();
+
+        for (qint64 i = 0; i < n; i++) {
+            double v = (double)data[i];
+
+            if (v == v) {
+                sorted.push_back(v);
+            }
+        }
+
+        sortData(true);
+    }
+
+    void clear();
+
+    // Number of samples
+    qint64 size() const;
+    bool isEmpty() const;
+
+    // Counts, each a binary search or two
+    qint64 countBelow(double v) const;                  // Samples < v
+    qint64 countAbove(double v) const;                  // Samples > v
+    qint64 countInside(double min, double max) const;   // Samples in [min, max]
+
+    // Smallest and largest samples
+    double getMinimum() const;
+    double getMaximum() const;
+
+    // Sample at the given fraction of the sorted data, in [0, 1]
+    double quantile(double q) const;
+
+    // Sample in [min, max] nearest to v, or v if there are none
+    double nearest(double v, double min, double max) const;
+
+    // Sample counts in evenly spaced bins from the minimum to the maximum.
+    // Each bin is two binary searches, and the last one asked for is cached.
+    // Safe to call from several threads at once, like the other const
+    // methods, but not while the data is being set.
+    QVector<qint64> histogram(int bins) const;
+
+    // Thresholds splitting the samples into the given number of classes with
+    // the least variance within classes (multi-level Otsu), from the histogram
+    QVector<double> otsuThresholds(int classes, int bins = 256) const;
+
+    // The sorted samples
+    const std::vector<double>& getSortedData() const;
+
+    // Sample index of each sorted sample, if kept
+    bool hasPermutation() const;
+    const std::vector<quint32>& getPermutation() const;
+
+protected:
+    std::vector<double> sorted;
+    std::vector<quint32> permutation;
+
+    // Cached histogram, guarded as the index is shared between widgets and
+    // worker threads
+    mutable QMutex histogramMutex;
+    mutable QVector<qint64> histogramCounts;
+
+    // Internal methods
+    void sortData(bool distinct = false);
+};
+
+
+#endif
\ No newline at end of file
@@ -14,17 +14,18 @@
 
 #include "QDoubleSlider.h"
 
+#include "QScientificSignalMonitor.h"
+
 #include <QSlider>
 #include <QDoubleSpinBox>
 
-#include <math.h>
-
 
 QDoubleSlider::QDoubleSlider(QSlider* slider, QDoubleSpinBox* spinBox, QObject* parent)
     : QObject(parent), slider(slider), spinBox(spinBox)
 {
     // Connect signals and slots
     connect(slider, SIGNAL(valueChanged(int)), this, SLOT(setValueFromSlider(int)));
+    connect(slider, SIGNAL(sliderPressed()), this, SLOT(pressSlider()));
     connect(slider, SIGNAL(sliderReleased()), this, SLOT(releaseSlider()));
     connect(spinBox, SIGNAL(valueChanged(double)), this, SLOT(setValueFromSpinBox(double)));
 
@@ -32,6 +33,13 @@ QDoubleSlider::QDoubleSlider(QSlider* slider, QDoubleSpinBox* spinBox, QObject*
 
     // XXX: Testing exponential
     exponent = 1.0;
+    accuracy = QPowExact;
+
+    // No updates yet
+    updateSequence = 0;
+    lastPhase = QInteractionFinal;
+    linkedUpdate = false;
+    qRegisterMetaType<QInteractionPhase>("QInteractionPhase");
 }
 
 
@@ -50,6 +58,22 @@ void QDoubleSlider::setValue(double value)
 }
 
 
+void QDoubleSlider::setValue(double value, QInteractionPhase phase)
+{
+    double old = this->value();
+
+    // Replace the updates setValue() emits with one in the given phase
+    linkedUpdate = true;
+    setValue(value);
+    linkedUpdate = false;
+
+    // An unchanged value only passes on the beginning or end of an interaction
+    if (this->value() != old || (phase != QInteractionPreview && phase != lastPhase)) {
+        emitValueUpdated(this->value(), phase);
+    }
+}
+
+
 void QDoubleSlider::setValueFromSlider(int value) 
 {
     // Set the spin box value
@@ -57,7 +81,7 @@ void QDoubleSlider::setValueFromSlider(int value)
 
 
     // XXX: Testing exponential
-    fraction = pow(fraction, exponent);
+    fraction = qPow(fraction, exponent, accuracy);
 
     
     double newValue = spinBox->minimum() + fraction * (spinBox->maximum() - spinBox->minimum());
@@ -65,13 +89,22 @@ void QDoubleSlider::setValueFromSlider(int value)
     spinBox->setValue(newValue);
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "valueChanged", newValue);
+
     emit valueChanged(newValue);
+    emitValueUpdated(newValue);
+}
+
+void QDoubleSlider::pressSlider()
+{
+    emitValueUpdated(value(), QInteractionBegin);
 }
 
 void QDoubleSlider::releaseSlider()
 {
-    // Just emit the appropriate signal
+    // Just emit the appropriate signals
     emit sliderReleased();
+    emitValueUpdated(value(), QInteractionFinal);
 }
 
 void QDoubleSlider::setValueFromSpinBox(double value) 
@@ -81,7 +114,7 @@ void QDoubleSlider::setValueFromSpinBox(double value)
 
 
     // XXX: Testing exponential
-    fraction = pow(fraction, 1.0 / exponent);
+    fraction = qPow(fraction, 1.0 / exponent, accuracy);
 
 
     slider->blockSignals(true);
@@ -89,7 +122,20 @@ void QDoubleSlider::setValueFromSpinBox(double value)
     slider->blockSignals(false);
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "valueChanged", value);
+
     emit valueChanged(value);
+    emitValueUpdated(value);
+}
+
+void QDoubleSlider::setAccuracy(QPowAccuracy accuracy)
+{
+    this->accuracy = accuracy;
+
+    // The value isn't actually changing, so block signals
+    blockSignals(true);
+    setValueFromSpinBox(spinBox->value());
+    blockSignals(false);
 }
 
 void QDoubleSlider::setExponent(double exponent)
@@ -101,3 +147,20 @@ void QDoubleSlider::setExponent(double exponent)
     setValueFromSpinBox(spinBox->value());
     blockSignals(false);
 }
+
+
+void QDoubleSlider::emitValueUpdated(double value)
+{
+    if (linkedUpdate) {
+        return;
+    }
+
+    emitValueUpdated(value, slider->isSliderDown() ? QInteractionPreview : QInteractionFinal);
+}
+
+void QDoubleSlider::emitValueUpdated(double value, QInteractionPhase phase)
+{
+    lastPhase = phase;
+
+    emit valueUpdated(value, phase, ++updateSequence);
+}
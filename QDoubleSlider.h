@@ -18,6 +18,9 @@
 
 #include <QObject>
 
+#include "QFastMath.h"
+#include "QInteractionPhase.h"
+
 
 class QSlider;
 class QDoubleSpinBox;
@@ -32,9 +35,16 @@ public:
 
     double value();
 
+    // Accuracy used for evaluating the power function
+    void setAccuracy(QPowAccuracy accuracy);
+
 public slots:
     void setValue(double value);
 
+    // As setValue(), but the update carries the given phase, as for
+    // QNonlinearSlider::setValue(double, QInteractionPhase)
+    void setValue(double value, QInteractionPhase phase);
+
     // XXX: Experimental 
     void setExponent(double exponent);
 
@@ -42,8 +52,12 @@ signals:
     void valueChanged(double value);
     void sliderReleased();
 
+    // Every value update, with its interaction phase and sequence number
+    void valueUpdated(double value, QInteractionPhase phase, qint64 sequence);
+
 private slots:
     void setValueFromSlider(int value);
+    void pressSlider();
     void releaseSlider();
     void setValueFromSpinBox(double value);
 
@@ -53,6 +67,17 @@ private:
 
     // XXX: Experimental
     double exponent;
+    QPowAccuracy accuracy;
+
+    // Sequence number and phase of the last valueUpdated(), and whether a
+    // setter's updates are being replaced by one with a given phase
+    qint64 updateSequence;
+    QInteractionPhase lastPhase;
+    bool linkedUpdate;
+
+    // Preview while the slider is held down, otherwise final
+    void emitValueUpdated(double value);
+    void emitValueUpdated(double value, QInteractionPhase phase);
 };
 
 
@@ -0,0 +1,91 @@
+/*=========================================================================
+
+  Name:        QDragPredictor.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Estimates the velocity of a dragged handle and predicts
+               where it will be shortly.
+
+=========================================================================*/
+
+
+#include "QDragPredictor.h"
+
+#include <QtGlobal>
+
+
+// Weight of the newest velocity sample in the smoothed velocity
+static const double velocitySmoothing = 0.5;
+
+
+QDragPredictor::QDragPredictor()
+{
+    interval = 50;
+
+    clock.start();
+
+    reset();
+}
+
+
+void QDragPredictor::reset()
+{
+    hasPosition = false;
+    positionTime = 0;
+
+    velocity = QPointF();
+
+    hintTime = -interval;
+}
+
+
+void QDragPredictor::addPosition(const QPointF& p)
+{
+    qint64 now = clock.elapsed();
+
+    if (hasPosition && now > positionTime) {
+        QPointF v = (p - position) / (double)(now - positionTime);
+
+        velocity = velocity * (1.0 - velocitySmoothing) + v * velocitySmoothing;
+    }
+
+    position = p;
+    positionTime = now;
+    hasPosition = true;
+}
+
+
+bool QDragPredictor::hintDue()
+{
+    qint64 now = clock.elapsed();
+
+    if (!hasPosition || now - hintTime < interval) {
+        return false;
+    }
+
+    hintTime = now;
+
+    return true;
+}
+
+
+QPointF QDragPredictor::predictPosition(int ms) const
+{
+    QPointF p = position + velocity * ms;
+
+    return QPointF(qBound(0.0, p.x(), 1.0), qBound(0.0, p.y(), 1.0));
+}
+
+
+int QDragPredictor::getInterval() const
+{
+    return interval;
+}
+
+void QDragPredictor::setInterval(int ms)
+{
+    interval = qMax(ms, 0);
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+/*=========================================================================
+
+  Name:        QDragPredictor.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Estimates the velocity of a dragged handle from its recent
+               positions, and predicts where it will be shortly, so widgets
+               can hint upcoming values to e.g. a renderer that prefetches
+               data for them.  Hints are rate limited to one per interval.
+
+=========================================================================*/
+
+
+#ifndef QDRAGPREDICTOR_H
+#define QDRAGPREDICTOR_H
+
+
+#include "QScientificMetaTypes.h"
+
+#include <QElapsedTimer>
+#include <QPointF>
+#include <QVector>
+
+
+class QDragPredictor
+{
+public:
+    QDragPredictor();
+
+    // Forgets the drag, e.g. when a new one starts
+    void reset();
+
+    // Adds the handle position, in normalized coordinates
+    void addPosition(const QPointF& p);
+
+    // Whether a hint interval has passed since the last hint.  Marks the
+    // hint as given if so.
+    bool hintDue();
+
+    // Predicted handle position the given time ahead, clamped to [0, 1]
+    QPointF predictPosition(int ms) const;
+
+    // Minimum time between hints, in milliseconds
+    int getInterval() const;
+    void setInterval(int ms);
+
+protected:
+    QElapsedTimer clock;
+
+    // Newest position and its time
+    QPointF position;
+    qint64 positionTime;
+    bool hasPosition;
+
+    // Smoothed velocity, per millisecond
+    QPointF velocity;
+
+    // Time of the last hint
+    int interval;
+    qint64 hintTime;
+};
+
+
+#endif
\ No newline at end of file
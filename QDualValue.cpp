@@ -14,7 +14,13 @@
 
 #include "QDualValue.h"
 
+#include "QDataIndex.h"
+#include "QScientificRepaintScheduler.h"
+#include "QScientificSignalMonitor.h"
+
 #include <QtCore/qmath.h>
+#include <QCoreApplication>
+#include <QEvent>
 #include <QPainter>
 #include <QMouseEvent>
 
@@ -35,6 +41,27 @@ QDualValue::QDualValue(QWidget* parent)
 
     moveSeparately = false;
 
+    // No data
+    windowMode = LowHighMode;
+
+    dataIndex = 0;
+    coverageVisible = false;
+
+    // No presets
+    currentPreset = -1;
+
+    // No hints
+    hintsEnabled = false;
+
+    // Hints may be queued to another thread
+    qRegisterMetaType<QVector<QPointF> >("QVector<QPointF>");
+
+    // No updates yet
+    updateSequence = 0;
+    lastPhase = QInteractionFinal;
+    linkedUpdate = false;
+    qRegisterMetaType<QInteractionPhase>("QInteractionPhase");
+
     // Appearance
     handleRadius = 7;
     lineWidth = handleRadius;
@@ -46,8 +73,20 @@ QDualValue::QDualValue(QWidget* parent)
     handle.setX(0.5);
     handle.setY(0.5);
 
+    widgetDirty = false;
+
     // No interaction to start with
     action = QDualValueNoAction;
+
+    // Nothing posted yet.  Register the event type here, from the GUI thread.
+    postedValue1 = value1;
+    postedValue2 = value2;
+    postedValuesPending = 0;
+    postedValuesEventType();
+
+    // Not in a transaction
+    transactionDepth = 0;
+    transactionSignalsBlocked = false;
 }
 
 
@@ -62,6 +101,27 @@ double QDualValue::getValue2() const
 }
 
 
+double QDualValue::getValue1Minimum() const
+{
+    return value1Minimum;
+}
+
+double QDualValue::getValue1Maximum() const
+{
+    return value1Maximum;
+}
+
+double QDualValue::getValue2Minimum() const
+{
+    return value2Minimum;
+}
+
+double QDualValue::getValue2Maximum() const
+{
+    return value2Maximum;
+}
+
+
 void QDualValue::setValue1(double v) 
 {
     // Set the value
@@ -73,13 +133,16 @@ void QDualValue::setValue1(double v)
 
     value1 = v;
 
-    setWidgetFromValues();
+    widgetDirty = true;
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "value1Changed", value1);
+
     emit value1Changed(value1);
+    emitValuesUpdated();
 
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
 }
 
 void QDualValue::setValue2(double v) 
@@ -93,13 +156,16 @@ void QDualValue::setValue2(double v)
 
     value2 = v;
 
-    setWidgetFromValues();
+    widgetDirty = true;
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "value2Changed", value2);
+
     emit value2Changed(value2);
+    emitValuesUpdated();
 
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
 }
 
 void QDualValue::setValues(double v1, double v2)
@@ -111,11 +177,14 @@ void QDualValue::setValues(double v1, double v2)
     if (v1 == value1 && v2 == value2) {
         return;
     }
-    else if (v1 != value1 && v2 != value2) {
+
+    QScientificSignalScope scope(this, "valuesChanged", v1, v2);
+
+    if (v1 != value1 && v2 != value2) {
         value1 = v1;
         value2 = v2;
 
-        setWidgetFromValues();
+        widgetDirty = true;
 
         // Emit the values as a signal
         emit valuesChanged(QPointF(value1, value2));
@@ -126,7 +195,7 @@ void QDualValue::setValues(double v1, double v2)
     else if (v1 != value1) {
         value1 = v1;
     
-        setWidgetFromValues();
+        widgetDirty = true;
 
         // Emit the value as a signal
         emit value1Changed(value1);
@@ -134,14 +203,50 @@ void QDualValue::setValues(double v1, double v2)
     else if (v2 != value2) {
         value2 = v2;
       
-        setWidgetFromValues();
+        widgetDirty = true;
 
         // Emit the value as a signal
         emit value2Changed(value2);
     }
+
+    emitValuesUpdated();
             
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+void QDualValue::setValue1(double v, QInteractionPhase phase)
+{
+    setValuesInPhase(v, value2, phase);
+}
+
+void QDualValue::setValue2(double v, QInteractionPhase phase)
+{
+    setValuesInPhase(value1, v, phase);
+}
+
+void QDualValue::setValues(QPointF values, QInteractionPhase phase)
+{
+    setValuesInPhase(values.x(), values.y(), phase);
+}
+
+void QDualValue::setValuesInPhase(double v1, double v2, QInteractionPhase phase)
+{
+    double old1 = value1;
+    double old2 = value2;
+
+    // Replace the update setValues() emits with one in the given phase
+    linkedUpdate = true;
+    setValues(v1, v2);
+    linkedUpdate = false;
+
+    // An unchanged value only passes on the beginning or end of an interaction
+    bool changed = value1 != old1 || value2 != old2;
+
+    if (changed || (phase != QInteractionPreview && phase != lastPhase)) {
+        emitValuesUpdated(phase);
+    }
 }
 
 
@@ -159,15 +264,23 @@ void QDualValue::setValue1Maximum(double max)
 
 void QDualValue::setValue1Range(double min, double max)
 {
-    int oldMin = value1Minimum;
-    int oldMax = value1Maximum;
+    double oldMin = value1Minimum;
+    double oldMax = value1Maximum;
 
     value1Minimum = qMin(min, max);
     value1Maximum = qMax(min, max);
 
     if (oldMin != value1Minimum || oldMax != value1Maximum) {
+        widgetDirty = true;
+
         // Ensure valid value
         setValue1(value1);
+
+        // Emit the range as a signal
+        emit value1RangeChanged(value1Minimum, value1Maximum);
+
+        // Repaint
+        QScientificRepaintScheduler::schedule(this);
     }
 }
 
@@ -186,15 +299,23 @@ void QDualValue::setValue2Maximum(double max)
 
 void QDualValue::setValue2Range(double min, double max)
 {
-    int oldMin = value2Minimum;
-    int oldMax = value2Maximum;
+    double oldMin = value2Minimum;
+    double oldMax = value2Maximum;
 
     value2Minimum = qMin(min, max);
     value2Maximum = qMax(min, max);
 
     if (oldMin != value2Minimum || oldMax != value2Maximum) {
+        widgetDirty = true;
+
         // Ensure valid value
         setValue2(value2);
+
+        // Emit the range as a signal
+        emit value2RangeChanged(value2Minimum, value2Maximum);
+
+        // Repaint
+        QScientificRepaintScheduler::schedule(this);
     }
 }
 
@@ -205,6 +326,266 @@ void QDualValue::setMoveSeparately(bool separately)
 }
 
 
+QDualValue::WindowMode QDualValue::getWindowMode() const
+{
+    return windowMode;
+}
+
+void QDualValue::setWindowMode(WindowMode mode)
+{
+    if (mode == windowMode) {
+        return;
+    }
+
+    windowMode = mode;
+
+    // Presets are the same windows, but described differently
+    emit presetsChanged();
+
+    if (coverageVisible) {
+        QScientificRepaintScheduler::schedule(this);
+    }
+}
+
+
+const QDataIndex* QDualValue::getDataIndex() const
+{
+    return dataIndex;
+}
+
+void QDualValue::setDataIndex(const QDataIndex* index)
+{
+    dataIndex = index;
+
+    updatePresets();
+
+    if (coverageVisible) {
+        QScientificRepaintScheduler::schedule(this);
+    }
+}
+
+
+bool QDualValue::getHintsEnabled() const
+{
+    return hintsEnabled;
+}
+
+void QDualValue::setHintsEnabled(bool enabled)
+{
+    hintsEnabled = enabled;
+}
+
+int QDualValue::getHintInterval() const
+{
+    return dragPredictor.getInterval();
+}
+
+void QDualValue::setHintInterval(int ms)
+{
+    dragPredictor.setInterval(ms);
+}
+
+
+int QDualValue::getPresetCount() const
+{
+    return presets.size();
+}
+
+QPointF QDualValue::getPreset(int i) const
+{
+    if (i < 0 || i >= presets.size()) {
+        return QPointF();
+    }
+
+    return valuesFromWindow(presets[i].x(), presets[i].y());
+}
+
+int QDualValue::getCurrentPreset() const
+{
+    return currentPreset;
+}
+
+
+void QDualValue::updatePresets()
+{
+    presets.clear();
+    currentPreset = -1;
+
+    if (dataIndex && !dataIndex->isEmpty()) {
+        double min = dataIndex->getMinimum();
+        double max = dataIndex->getMaximum();
+
+        presets.append(QPointF(min, max));
+
+        // All class counts share the cached histogram
+        for (int classes = 2; classes <= 4; classes++) {
+            QVector<double> thresholds = dataIndex->otsuThresholds(classes);
+
+            thresholds.prepend(min);
+            thresholds.append(max);
+
+            for (int i = 0; i + 1 < thresholds.size(); i++) {
+                QPointF window(thresholds[i], thresholds[i + 1]);
+
+                if (window.x() < window.y() && !presets.contains(window)) {
+                    presets.append(window);
+                }
+            }
+        }
+    }
+
+    emit presetsChanged();
+}
+
+void QDualValue::applyPreset(int i)
+{
+    if (i < 0 || i >= presets.size()) {
+        return;
+    }
+
+    currentPreset = i;
+
+    QPointF values = getPreset(i);
+
+    setValues(values.x(), values.y());
+}
+
+void QDualValue::nextPreset()
+{
+    if (presets.isEmpty()) {
+        return;
+    }
+
+    applyPreset((currentPreset + 1) % presets.size());
+}
+
+
+qint64 QDualValue::getCountBelow() const
+{
+    return dataIndex ? dataIndex->countBelow(windowLow()) : 0;
+}
+
+qint64 QDualValue::getCountInside() const
+{
+    return dataIndex ? dataIndex->countInside(windowLow(), windowHigh()) : 0;
+}
+
+qint64 QDualValue::getCountAbove() const
+{
+    return dataIndex ? dataIndex->countAbove(windowHigh()) : 0;
+}
+
+
+bool QDualValue::getCoverageVisible() const
+{
+    return coverageVisible;
+}
+
+void QDualValue::setCoverageVisible(bool visible)
+{
+    if (visible == coverageVisible) {
+        return;
+    }
+
+    coverageVisible = visible;
+
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+void QDualValue::postValues(double v1, double v2)
+{
+    // Store the newest values
+    postedValuesMutex.lock();
+    postedValue1 = v1;
+    postedValue2 = v2;
+    postedValuesMutex.unlock();
+
+    // Only post an event if one isn't already pending
+    if (postedValuesPending.testAndSetOrdered(0, 1)) {
+        QCoreApplication::postEvent(this, new QEvent(postedValuesEventType()));
+    }
+}
+
+
+void QDualValue::beginTransaction()
+{
+    if (transactionDepth++ > 0) {
+        return;
+    }
+
+    // Save the current state, and hold back signals until the end
+    transactionValue1 = value1;
+    transactionValue2 = value2;
+    transactionValue1Minimum = value1Minimum;
+    transactionValue1Maximum = value1Maximum;
+    transactionValue2Minimum = value2Minimum;
+    transactionValue2Maximum = value2Maximum;
+
+    transactionSignalsBlocked = blockSignals(true);
+}
+
+void QDualValue::endTransaction()
+{
+    if (transactionDepth == 0 || --transactionDepth > 0) {
+        return;
+    }
+
+    blockSignals(transactionSignalsBlocked);
+
+    // Emit what changed, once, in the same way as setValues()
+    bool changed1 = value1 != transactionValue1;
+    bool changed2 = value2 != transactionValue2;
+
+    QScientificSignalScope scope(this, "valuesChanged", value1, value2);
+
+    if (changed1 && changed2) {
+        emit valuesChanged(QPointF(value1, value2));
+    }
+
+    if (changed1) {
+        emit value1Changed(value1);
+    }
+
+    if (changed2) {
+        emit value2Changed(value2);
+    }
+
+    if (changed1 || changed2) {
+        emitValuesUpdated();
+    }
+
+    if (value1Minimum != transactionValue1Minimum || value1Maximum != transactionValue1Maximum) {
+        emit value1RangeChanged(value1Minimum, value1Maximum);
+    }
+
+    if (value2Minimum != transactionValue2Minimum || value2Maximum != transactionValue2Maximum) {
+        emit value2RangeChanged(value2Minimum, value2Maximum);
+    }
+}
+
+
+bool QDualValue::event(QEvent* event)
+{
+    if (event->type() == postedValuesEventType()) {
+        // Clear the pending flag before reading, so values posted after this
+        // read will post a new event
+        postedValuesPending.fetchAndStoreOrdered(0);
+
+        postedValuesMutex.lock();
+        double v1 = postedValue1;
+        double v2 = postedValue2;
+        postedValuesMutex.unlock();
+
+        setValues(v1, v2);
+
+        return true;
+    }
+
+    return QWidget::event(event);
+}
+
+
 void QDualValue::mousePressEvent(QMouseEvent* event)
 {
     // Only care about left-button presses
@@ -223,6 +604,9 @@ void QDualValue::mousePressEvent(QMouseEvent* event)
     p.setX(qBound(0, p.x(), width()));
     p.setY(qBound(0, p.y(), height()));
 
+    // Make sure the handle and lines are up to date
+    ensureWidget();
+
     // Intersect with controls
     action = QDualValueNoAction;
 
@@ -243,6 +627,13 @@ void QDualValue::mousePressEvent(QMouseEvent* event)
 
     // Save mouse position
     oldMousePosition = p;
+
+    // Velocity is per drag
+    dragPredictor.reset();
+
+    if (action != QDualValueNoAction) {
+        emitValuesUpdated(QInteractionBegin);
+    }
 }
 
 
@@ -274,6 +665,8 @@ void QDualValue::mouseReleaseEvent(QMouseEvent* event)
 
     // Clear action variable
     action = QDualValueNoAction;
+
+    emitValuesUpdated(QInteractionFinal);
 }
 
 
@@ -351,9 +744,11 @@ void QDualValue::mouseMoveEvent(QMouseEvent* event)
         
     // Save the widget position
     oldHandlePosition = handle;
+
+    updateHint();
     
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
 }
 
 
@@ -363,7 +758,7 @@ void QDualValue::paintEvent(QPaintEvent* event)
 
 
     // Positions and sizes may need to change
-//    setWidgetFromValues();
+    ensureWidget();
     updateLines();
         
 
@@ -400,11 +795,55 @@ void QDualValue::paintEvent(QPaintEvent* event)
     painter.drawEllipse(pixelsFromWidget(handle), handleRadius, handleRadius);
 
 
+    // Draw coverage
+    if (coverageVisible && dataIndex && !dataIndex->isEmpty()) {
+        QFont font = painter.font();
+
+        if (font.pointSizeF() > 0.0) {
+            font.setPointSizeF(font.pointSizeF() * 0.75);
+        }
+
+        painter.setFont(font);
+        painter.setPen(palette().text().color());
+
+        painter.drawText(rect().adjusted(borderX + 1, borderY, -borderX - 1, -borderY), Qt::AlignTop | Qt::AlignHCenter,
+                         QString("%1%").arg(100.0 * getCountInside() / dataIndex->size(), 0, 'f', 1));
+    }
+
+
     // Draw text
 //    painter.drawText(rect(), Qt::AlignCenter, locale().toString(value1, 'e', 4));
 }
 
 
+double QDualValue::windowLow() const
+{
+    if (windowMode == WidthLevelMode) {
+        return value2 - qAbs(value1) * 0.5;
+    }
+
+    return qMin(value1, value2);
+}
+
+double QDualValue::windowHigh() const
+{
+    if (windowMode == WidthLevelMode) {
+        return value2 + qAbs(value1) * 0.5;
+    }
+
+    return qMax(value1, value2);
+}
+
+QPointF QDualValue::valuesFromWindow(double low, double high) const
+{
+    if (windowMode == WidthLevelMode) {
+        return QPointF(high - low, (low + high) * 0.5);
+    }
+
+    return QPointF(low, high);
+}
+
+
 void QDualValue::setWidgetFromValues()
 {
     handle.setX((value1 - value1Minimum) / (value1Maximum - value1Minimum));
@@ -413,6 +852,23 @@ void QDualValue::setWidgetFromValues()
     updateLines();
 }
 
+void QDualValue::ensureWidget()
+{
+    if (widgetDirty) {
+        setWidgetFromValues();
+
+        widgetDirty = false;
+    }
+}
+
+QEvent::Type QDualValue::postedValuesEventType()
+{
+    static QEvent::Type type = (QEvent::Type)QEvent::registerEventType();
+
+    return type;
+}
+
+
 void QDualValue::updateLines()
 {
     QPointF h = pixelsFromWidget(handle);
@@ -433,7 +889,10 @@ void QDualValue::setValue1FromWidget()
     value1 = v;
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "value1Changed", value1);
+
     emit value1Changed(value1);
+    emitValuesUpdated();
 }
 
 void QDualValue::setValue2FromWidget()
@@ -447,7 +906,10 @@ void QDualValue::setValue2FromWidget()
     value2 = v;
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "value2Changed", value2);
+
     emit value2Changed(value2);
+    emitValuesUpdated();
 }
 
 void QDualValue::setValuesFromWidget()
@@ -459,7 +921,10 @@ void QDualValue::setValuesFromWidget()
     if (v1 == value1 && v2 == value2) {
         return;
     }
-    else if (v1 != value1 && v2 != value2) {
+
+    QScientificSignalScope scope(this, "valuesChanged", v1, v2);
+
+    if (v1 != value1 && v2 != value2) {
         value1 = v1;
         value2 = v2;
         
@@ -481,10 +946,58 @@ void QDualValue::setValuesFromWidget()
         // Emit the value as a signal
         emit value2Changed(value2);
     }
+
+    emitValuesUpdated();
 }
 
 
 
+void QDualValue::emitValuesUpdated()
+{
+    if (linkedUpdate) {
+        return;
+    }
+
+    emitValuesUpdated(action == QDualValueNoAction ? QInteractionFinal : QInteractionPreview);
+}
+
+void QDualValue::emitValuesUpdated(QInteractionPhase phase)
+{
+    lastPhase = phase;
+
+    emit valuesUpdated(QPointF(value1, value2), phase, ++updateSequence);
+}
+
+
+void QDualValue::updateHint()
+{
+    dragPredictor.addPosition(handle);
+
+    if (!hintsEnabled || !dragPredictor.hintDue()) {
+        return;
+    }
+
+    // Values at the next few hint intervals, without repeats
+    QVector<QPointF> values;
+    QPointF last(value1, value2);
+
+    for (int i = 1; i <= 3; i++) {
+        QPointF p = dragPredictor.predictPosition(i * dragPredictor.getInterval());
+        QPointF v(value1FromWidget(p.x()), value2FromWidget(p.y()));
+
+        if (v != last) {
+            values.append(v);
+        }
+
+        last = v;
+    }
+
+    if (!values.isEmpty()) {
+        emit valuesHint(values);
+    }
+}
+
+
 double QDualValue::value1FromWidget(double x) const
 {
     return value1Minimum + x * (value1Maximum - value1Minimum);
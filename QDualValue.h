@@ -16,7 +16,17 @@
 #define QDUALVALUE_H
 
 
+#include "QDragPredictor.h"
+#include "QInteractionPhase.h"
+#include "QScientificMetaTypes.h"
+
 #include <QWidget>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QPointF>
+#include <QVector>
+
+class QDataIndex;
 
 
 class QDualValue : public QWidget
@@ -26,9 +36,20 @@ class QDualValue : public QWidget
 public:
     QDualValue(QWidget* parent = 0);
 
+    // How values 1 and 2 describe the window used for coverage and presets
+    enum WindowMode {
+        LowHighMode,        // Value 1 and value 2 are the window's ends
+        WidthLevelMode      // Value 1 is the window width, value 2 its center
+    };
+
     double getValue1() const;
     double getValue2() const;
 
+    double getValue1Minimum() const;
+    double getValue1Maximum() const;
+    double getValue2Minimum() const;
+    double getValue2Maximum() const;
+
     void setValue1Minimum(double min);
     void setValue1Maximum(double max);
     void setValue1Range(double min, double max);
@@ -39,11 +60,64 @@ public:
 
     void setMoveSeparately(bool separately);
 
+    // LowHighMode by default
+    WindowMode getWindowMode() const;
+    void setWindowMode(WindowMode mode);
+
+    // Data to count samples in the window, not owned
+    const QDataIndex* getDataIndex() const;
+    void setDataIndex(const QDataIndex* index);
+
+    // Numbers of samples below, inside and above the window, or 0 without data
+    qint64 getCountBelow() const;
+    qint64 getCountInside() const;
+    qint64 getCountAbove() const;
+
+    // Whether to draw the fraction of samples inside the window
+    bool getCoverageVisible() const;
+    void setCoverageVisible(bool visible);
+
+    // Window presets from the data index, as value 1 and value 2 in x and y
+    // for the current window mode: the full data range, then each class of
+    // 2, 3 and 4 class Otsu thresholds.  Recomputed by setDataIndex() and
+    // updatePresets().
+    int getPresetCount() const;
+    QPointF getPreset(int i) const;
+    int getCurrentPreset() const;
+
+    // Whether to emit valuesHint() while dragging, off by default, and the
+    // minimum time between hints in milliseconds
+    bool getHintsEnabled() const;
+    void setHintsEnabled(bool enabled);
+    int getHintInterval() const;
+    void setHintInterval(int ms);
+
+    // Thread-safe alternative to setValues() for feeding values from worker threads.
+    // Only the newest values are kept, and at most one event is pending at a time,
+    // so the GUI thread applies just the latest values however fast they arrive.
+    void postValues(double v1, double v2);
+
+    // Group several setter calls, so each changed signal is emitted once, with
+    // the final values, by the outermost endTransaction().  Calls may be nested.
+    void beginTransaction();
+    void endTransaction();
+
 public slots:
     void setValue1(double v);
     void setValue2(double v);
     void setValues(double v1, double v2);
 
+    // As the setters above, but the update carries the given phase, e.g.
+    // from another widget's valueUpdated() or valuesUpdated(), as for
+    // QNonlinearSlider::setValue(double, QInteractionPhase)
+    void setValue1(double v, QInteractionPhase phase);
+    void setValue2(double v, QInteractionPhase phase);
+    void setValues(QPointF values, QInteractionPhase phase);
+
+    void updatePresets();
+    void applyPreset(int i);
+    void nextPreset();
+
 signals:
     void value1Changed(double v);
     void releaseValue1();
@@ -52,8 +126,22 @@ signals:
     void releaseValue2();
 
     void valuesChanged(QPointF values);
+
+    // Every update of either value, with its interaction phase and sequence
+    // number.  Unlike valuesChanged(), also emitted when a drag begins and
+    // ends, and when only one value changes.
+    void valuesUpdated(QPointF values, QInteractionPhase phase, qint64 sequence);
+    void value1RangeChanged(double min, double max);
+    void value2RangeChanged(double min, double max);
     void releaseValues();
 
+    // Values the handle is predicted to reach over the next few hint
+    // intervals at its current drag velocity, as value 1 and value 2 in x and
+    // y, e.g. for prefetching.  Only a hint: the values have not changed.
+    void valuesHint(const QVector<QPointF>& values);
+
+    void presetsChanged();
+
 protected:
     // Values
     double value1;
@@ -70,6 +158,27 @@ protected:
     // Separate horizontal and vertical motion or not
     bool moveSeparately;
 
+    // How the values describe the window
+    WindowMode windowMode;
+
+    // Data for coverage counts, and whether to draw them
+    const QDataIndex* dataIndex;
+    bool coverageVisible;
+
+    // Sequence number and phase of the last valuesUpdated(), and whether a
+    // setter's update is being replaced by one with a given phase
+    qint64 updateSequence;
+    QInteractionPhase lastPhase;
+    bool linkedUpdate;
+
+    // Drag velocity for value hints
+    QDragPredictor dragPredictor;
+    bool hintsEnabled;
+
+    // Window presets, as the window's ends, and the one applied last, or -1
+    QVector<QPointF> presets;
+    int currentPreset;
+
     // Position of handle, in normalized coordinates
     QPointF handle;
     
@@ -85,6 +194,26 @@ protected:
     int borderX;
     int borderY;
 
+    // Whether the handle needs to be recomputed from the values.  Setters just
+    // mark this, and it is recomputed before painting or interaction.
+    bool widgetDirty;
+
+    // Newest values from postValues(), and whether an event to apply them is pending
+    QMutex postedValuesMutex;
+    double postedValue1;
+    double postedValue2;
+    QAtomicInt postedValuesPending;
+
+    // Transaction state, and the values before the outermost beginTransaction()
+    int transactionDepth;
+    bool transactionSignalsBlocked;
+    double transactionValue1;
+    double transactionValue2;
+    double transactionValue1Minimum;
+    double transactionValue1Maximum;
+    double transactionValue2Minimum;
+    double transactionValue2Maximum;
+
     // Mouse interaction variables
     QPoint oldMousePosition;
     QPointF oldHandlePosition;
@@ -98,6 +227,8 @@ protected:
     QDualValueAction action;
 
     // Internal methods
+    virtual bool event(QEvent* event);
+
     virtual void mousePressEvent(QMouseEvent* event);
     virtual void mouseReleaseEvent(QMouseEvent* event);
     virtual void mouseMoveEvent(QMouseEvent* event);
@@ -107,6 +238,24 @@ protected:
     virtual void setWidgetFromValues();
     virtual void updateLines();
 
+    void ensureWidget();
+
+    // Ends of the window the values describe, and values for a window
+    double windowLow() const;
+    double windowHigh() const;
+    QPointF valuesFromWindow(double low, double high) const;
+
+    // Tracks the dragged handle, and emits valuesHint() when due
+    void updateHint();
+
+    // Preview while dragging, otherwise final
+    void emitValuesUpdated();
+    void emitValuesUpdated(QInteractionPhase phase);
+
+    void setValuesInPhase(double v1, double v2, QInteractionPhase phase);
+
+    static QEvent::Type postedValuesEventType();
+
     virtual void setValue1FromWidget();
     virtual void setValue2FromWidget();
     virtual void setValuesFromWidget();
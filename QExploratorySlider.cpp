@@ -14,84 +14,318 @@
 
 #include "QExploratorySlider.h"
 
+#include "QDataIndex.h"
+#include "QScientificRepaintScheduler.h"
+
 #include <QtCore/qmath.h>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QtConcurrentMap>
 
 
-QExploratorySlider::QExploratorySlider(QWidget* parent)
-    : QNonlinearSlider(parent)
-{
-    // Default to linear function
-    exponent = 1.0;
+// Fit parameters: distribution samples, grid points per side, refinement
+// rounds, and the exponent search range as base 2 logarithms
+static const int fitSampleCount = 256;
+static const int fitGridSize = 33;
+static const int fitRoundCount = 4;
+static const double fitLogExponentLimit = 5.0;
+
+
+struct QExploratorySlider::FitRow {
+    typedef FitResult result_type;
+
+    QVector<double> quantiles;
+    QPowAccuracy accuracy;
+
+    double logExponentMin;
+    double logExponentStep;
 
-    // Default pivot value
-    pivotValue = 0.5;
-   
-    // Build the curve
-    buildCurve();
+    FitResult operator()(double pivotValue) const
+    {
+        FitResult best;
+        best.error = -1.0;
 
+        int n = quantiles.size() - 1;
+
+        for (int i = 0; i < fitGridSize; i++) {
+            double e = qPow(2.0, logExponentMin + i * logExponentStep);
+
+            QExploratoryMapping mapping(e, pivotValue, accuracy);
+
+            double error = 0.0;
+
+            for (int j = 0; j <= n; j++) {
+                double d = mapping.yFromX((double)j / n) - quantiles[j];
+
+                error += d * d;
+            }
+
+            if (best.error < 0.0 || error < best.error) {
+                best.error = error;
+                best.exponent = e;
+                best.pivotValue = pivotValue;
+            }
+        }
+
+        return best;
+    }
+};
+
+
+QExploratorySlider::QExploratorySlider(QWidget* parent)
+    : QMappedSlider<QExploratoryMapping>(parent)
+{
     // No interaction to start with
     action = QExploratorySliderNoAction;
 
     // Appearance
     pivotRadius = 1.5;
+
+    // Not fitting
+    fitRound = 0;
+
+    connect(&fitWatcher, SIGNAL(progressValueChanged(int)), this, SLOT(fitRowsProgressed(int)));
+    connect(&fitWatcher, SIGNAL(finished()), this, SLOT(fitRoundFinished()));
+}
+
+QExploratorySlider::~QExploratorySlider()
+{
+    // Rows in flight only use copies, but don't leave them running
+    cancelFit();
 }
 
 
 double QExploratorySlider::getExponent()
 {
-    return exponent;
+    return mapping.getExponent();
 }
 
 
 void QExploratorySlider::setExponent(double e)
 {
-    if (e == exponent) {
+    if (e == mapping.getExponent()) {
         return;
     }
 
-    exponent = e;
-
-    // Build the curve
-    buildCurve();
+    // Set the exponent and rebuild the curve
+    mapping.setExponent(e);
 
-    // Update the handle
-    setHandleFromValue();
+    // Curve and handle need updating
+    invalidateCurve();
 
     // Emit the exponent as a signal
-    emit exponentChanged(exponent);
+    emit exponentChanged(mapping.getExponent());
+    emit curveChanged();
 
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
 }
 
 
 double QExploratorySlider::getPivotValue()
 {
-    return pivotValue;
+    return mapping.getPivotValue();
 }
 
 
 void QExploratorySlider::setPivotValue(double pv)
 {
-    if (pv == pivotValue) {
+    if (pv == mapping.getPivotValue()) {
         return;
     }
 
-    pivotValue = pv;
+    // Set the pivot value and rebuild the curve
+    mapping.setPivotValue(pv);
 
-    // Build the curve
-    buildCurve();
-
-    // Update the handle
-    setHandleFromValue();
+    // Curve and handle need updating
+    invalidateCurve();
 
     // Emit the pivot value as a signal
-    emit pivotValueChanged(pivotValue);
+    emit pivotValueChanged(mapping.getPivotValue());
+    emit curveChanged();
     
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QPowAccuracy QExploratorySlider::getAccuracy() const
+{
+    return mapping.getAccuracy();
+}
+
+
+void QExploratorySlider::setAccuracy(QPowAccuracy accuracy)
+{
+    if (accuracy == mapping.getAccuracy()) {
+        return;
+    }
+
+    mapping.setAccuracy(accuracy);
+
+    // Curve and handle need updating
+    invalidateCurve();
+
+    emit curveChanged();
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QCurveCoefficients QExploratorySlider::getCoefficients() const
+{
+    return QCurveCoefficients(mapping, minimum, maximum);
+}
+
+
+void QExploratorySlider::beginTransaction()
+{
+    if (transactionDepth == 0) {
+        transactionExponent = mapping.getExponent();
+        transactionPivotValue = mapping.getPivotValue();
+    }
+
+    QNonlinearSlider::beginTransaction();
+}
+
+void QExploratorySlider::endTransaction()
+{
+    bool outermost = transactionDepth == 1;
+
+    QNonlinearSlider::endTransaction();
+
+    if (!outermost) {
+        return;
+    }
+
+    if (mapping.getExponent() != transactionExponent) {
+        emit exponentChanged(mapping.getExponent());
+    }
+
+    if (mapping.getPivotValue() != transactionPivotValue) {
+        emit pivotValueChanged(mapping.getPivotValue());
+    }
+
+    if (mapping.getExponent() != transactionExponent || mapping.getPivotValue() != transactionPivotValue) {
+        emit curveChanged();
+    }
+}
+
+
+bool QExploratorySlider::isFitting() const
+{
+    return fitWatcher.isRunning();
+}
+
+
+void QExploratorySlider::fitToData()
+{
+    cancelFit();
+
+    if (!dataIndex || dataIndex->isEmpty()) {
+        return;
+    }
+
+    // Subsample the distribution, so the fit costs the same for any data size
+    double range = maximum - minimum;
+
+    fitQuantiles.resize(fitSampleCount + 1);
+
+    for (int i = 0; i <= fitSampleCount; i++) {
+        double v = dataIndex->quantile((double)i / fitSampleCount);
+
+        fitQuantiles[i] = range > 0.0 ? qBound(0.0, (v - minimum) / range, 1.0) : 0.0;
+    }
+
+    // Start with the whole parameter space
+    fitLogExponentMin = -fitLogExponentLimit;
+    fitLogExponentMax = fitLogExponentLimit;
+    fitPivotMin = 0.0;
+    fitPivotMax = 1.0;
+    fitRound = 0;
+
+    emit fitProgress(0);
+
+    startFitRound();
+}
+
+void QExploratorySlider::cancelFit()
+{
+    if (fitWatcher.isRunning()) {
+        fitWatcher.cancel();
+        fitWatcher.waitForFinished();
+    }
+}
+
+
+void QExploratorySlider::fitRowsProgressed(int rows)
+{
+    emit fitProgress((fitRound * fitGridSize + rows) * 100 / (fitRoundCount * fitGridSize));
+}
+
+void QExploratorySlider::fitRoundFinished()
+{
+    QFuture<FitResult> future = fitWatcher.future();
+
+    if (future.isCanceled()) {
+        return;
+    }
+
+    // Best of all rows
+    FitResult best = future.resultAt(0);
+
+    for (int i = 1; i < future.resultCount(); i++) {
+        if (future.resultAt(i).error < best.error) {
+            best = future.resultAt(i);
+        }
+    }
+
+    fitRound++;
+
+    if (fitRound < fitRoundCount) {
+        // Zoom in on the best grid point, two grid steps either side
+        double logExponent = qLn(best.exponent) / qLn(2.0);
+        double logExponentStep = (fitLogExponentMax - fitLogExponentMin) / (fitGridSize - 1);
+        double pivotStep = (fitPivotMax - fitPivotMin) / (fitGridSize - 1);
+
+        fitLogExponentMin = qMax(logExponent - 2.0 * logExponentStep, -fitLogExponentLimit);
+        fitLogExponentMax = qMin(logExponent + 2.0 * logExponentStep, fitLogExponentLimit);
+        fitPivotMin = qMax(best.pivotValue - 2.0 * pivotStep, 0.0);
+        fitPivotMax = qMin(best.pivotValue + 2.0 * pivotStep, 1.0);
+
+        startFitRound();
+
+        return;
+    }
+
+    // Apply both at once
+    beginTransaction();
+    setExponent(best.exponent);
+    setPivotValue(best.pivotValue);
+    endTransaction();
+
+    emit fitProgress(100);
+    emit fitFinished();
+}
+
+
+void QExploratorySlider::startFitRound()
+{
+    // Pivot values for each row
+    QVector<double> pivotValues(fitGridSize);
+
+    for (int i = 0; i < fitGridSize; i++) {
+        pivotValues[i] = fitPivotMin + (fitPivotMax - fitPivotMin) * i / (fitGridSize - 1);
+    }
+
+    FitRow row;
+    row.quantiles = fitQuantiles;
+    row.accuracy = mapping.getAccuracy();
+    row.logExponentMin = fitLogExponentMin;
+    row.logExponentStep = (fitLogExponentMax - fitLogExponentMin) / (fitGridSize - 1);
+
+    fitWatcher.setFuture(QtConcurrent::mapped(pivotValues, row));
 }
 
 
@@ -113,6 +347,9 @@ void QExploratorySlider::mousePressEvent(QMouseEvent* event)
     p.setX(qBound(0, p.x(), width()));
     p.setY(qBound(0, p.y(), height()));
 
+    // Make sure the handle is up to date
+    ensureGeometry();
+
     // Intersect with controls
     action = QExploratorySliderNoAction;
 
@@ -127,6 +364,8 @@ void QExploratorySlider::mousePressEvent(QMouseEvent* event)
         action = QExploratorySliderChangeExponent;
     }
 
+    setDragging(true);
+
     // Save mouse position
     oldMousePosition = p;
 }
@@ -181,6 +420,9 @@ void QExploratorySlider::mouseReleaseEvent(QMouseEvent* event)
 
     // Clear action variable
     action = QExploratorySliderNoAction;
+
+    // Back to full quality
+    setDragging(false);
 }
 
 
@@ -216,11 +458,11 @@ void QExploratorySlider::mouseMoveEvent(QMouseEvent* event)
         case QExploratorySliderChangeExponent:
             if (delta.y() < 0) {
                 // Increase exponent
-                setExponent(exponent * 1.1);
+                setExponent(mapping.getExponent() * 1.1);
             }
             else if (delta.y() > 0) {
                 // Decrease exponent
-                setExponent(exponent / 1.1);
+                setExponent(mapping.getExponent() / 1.1);
             }
 
             break;
@@ -230,7 +472,7 @@ void QExploratorySlider::mouseMoveEvent(QMouseEvent* event)
     oldHandlePosition = handle;
     
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
 }
 
 
@@ -240,198 +482,32 @@ void QExploratorySlider::paintEvent(QPaintEvent* event)
 
 
     // Positions and sizes may need to change
-//    setHandleFromValue();
-
-
-    // Draw background cross
-    painter.setRenderHint(QPainter::Antialiasing, false);
-
-    painter.setPen(palette().midlight());
-
-    painter.drawLine(pixelsFromWidget(QPointF(0.5, 0.0)), pixelsFromWidget(QPointF(0.5, 1.0)));
-    painter.drawLine(pixelsFromWidget(QPointF(0.0, 0.5)), pixelsFromWidget(QPointF(1.0, 0.5)));
-
-    
-    // Draw border
-    painter.setRenderHint(QPainter::Antialiasing, false);
-
-    painter.setPen(palette().mid());
-    painter.setBrush(Qt::NoBrush);    
-
-    painter.drawRect(borderX - 1, borderY - 1, functionWidth() + 1, functionHeight() + 1);
-
-
-    // Draw function
-//    painter.setPen(Qt::black);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    QPointF previous(borderX, functionHeight() + borderY);
-    for (int i = borderX + 1; i <= borderX + functionWidth(); i++) {
-        double x = (double)(i - borderX) / functionWidth();
-        double y = widgetYFromValue(valueFromWidgetX(x));
-
-        QPointF p = pixelsFromWidget(QPointF(x, y));
-
-        painter.drawLine(previous, p);
-
-        previous = p;
-    }
-    
-
-    // Draw pivot
-    painter.setBrush(palette().mid());
-
-    painter.drawEllipse(pixelsFromWidget(QPointF(widgetXFromValue(valueFromWidgetY(pivotValue)), pivotValue)), pivotRadius, pivotRadius);
-
-
-    // Draw value
-    QColor color = palette().window().color();
-    painter.setBrush(color);
-
-    painter.drawEllipse(pixelsFromWidget(QPointF(handle.x(), widgetYFromValue(value))), valueRadius, valueRadius);
+    ensureGeometry();
 
 
-    // Draw handle
-    color.setAlphaF(0.5);
-    painter.setBrush(color);
-    painter.setPen(Qt::black);
+    // Draw
+    QNonlinearSliderPainter sliderPainter = getSliderPainter();
+    sliderPainter.setPivotRadius(pivotRadius);
 
-    painter.drawEllipse(pixelsFromWidget(handle), handleRadius, handleRadius);
+    double pivotValue = mapping.getPivotValue();
 
+    // Skip decorations while dragging at reduced quality
+    bool decorations = renderQuality() == FullQuality;
 
-    // Draw text
-//    painter.drawText(rect(), Qt::AlignTop, locale().toString(value, 'e', 4));
-}
-
-
-double QExploratorySlider::widgetXFromValue(double v) const
-{
-    // Find the x position
-    double x;
-    double y = widgetYFromValue(v);
-
-    if (exponent < 1.0) {
-        double e = 1.0 / exponent;
-
-        if (y <= curvePoint2.y()) {
-            x = evaluateCurveInverse(y, curvePoint1, curvePoint2, 1.0 / e);
-        }
-        else {
-            x = evaluateCurveInverse(y, curvePoint3, curvePoint2, 1.0 / e);
-        }
-    }
-    else {
-        double e = exponent;
-
-        if (y <= curvePoint2.y()) {
-            x = evaluateCurveInverse(y, curvePoint2, curvePoint1, 1.0 / e);
-        }
-        else {
-            x = evaluateCurveInverse(y, curvePoint2, curvePoint3, 1.0 / e);
-        }
+    if (decorations) {
+        sliderPainter.drawBackground(&painter, palette());
     }
 
-    return x;
-}
-
-double QExploratorySlider::valueFromWidgetX(double x) const
-{
-    // Map from x to y
-    double y;
-
-    if (exponent < 1.0) {
-        double e = 1.0 / exponent;
-
-        if (x <= curvePoint2.x()) {
-            y = evaluateCurve(x, curvePoint1, curvePoint2, e);
-        }
-        else {
-            y = evaluateCurve(x, curvePoint3, curvePoint2, e);
-        }
-    }
-    else {
-        double e = exponent;
+    sliderPainter.drawBorder(&painter, palette());
+    drawTicks(&painter);
+    sliderPainter.drawCurve(&painter, palette(), curve);
 
-        if (x <= curvePoint2.x()) {
-            y = evaluateCurve(x, curvePoint2, curvePoint1, e);
-        }
-        else {
-            y = evaluateCurve(x, curvePoint2, curvePoint3, e);
-        }
+    if (decorations) {
+        sliderPainter.drawPivot(&painter, palette(), mapping.xFromY(pivotValue), pivotValue);
     }
 
-    // Map to value space
-    return valueFromWidgetY(y);
-}
-
-
-void QExploratorySlider::buildCurve()
-{
-    // XXX: Explain better
-
-    // When exponent is greater than 1.0, we use two curves moving away from the pivot.
-    // When exponent is less than 1.0, we invert the exponent, but use two curves moving
-    // away from 0 and 1.  This enables flattening the values either at either side of the 
-    // pivot, or from 0 or 1 to the pivot.  When exponent is less than 1.0, we also use
-    // 1.0 - pivot as the pivot value to make the curve longer.
-
-    bool invert = exponent < 1.0;
-
-    // The exponent and pivot value
-    double e = invert ? 1.0 / exponent : exponent;
-    double pv = invert ? 1.0 - pivotValue : pivotValue;
-
-    // Find the smallest distance from the pivot value to 0 or 1
-    double pivotDistance = qMin(pv, 1.0 - pv);
-
-    // Find the height of the curves
-    double curveHeight = 1.0 - pivotDistance;
-
-    // Find the x-intercept with the top or bottom
-    double intercept = invert ? 1.0 - qPow(1.0 - pivotDistance / curveHeight, 1.0 / e) 
-                              : qPow(pivotDistance / curveHeight, 1.0 / e);
-
-    // Find the x pivot position
-    double pivotX = pv <= 0.5 ? intercept : 1.0;
-    pivotX /= (1.0 + intercept);
-
-    // Find the width of the curves, based on the x pivot position
-    double curveWidth = qMax(pivotX, 1.0 - pivotX);
-
-    // Find the points of the curve
-    curvePoint1 = QPointF(pivotX - curveWidth, pv - curveHeight);
-    curvePoint2 = QPointF(pivotX, pv);
-    curvePoint3 = QPointF(pivotX + curveWidth, pv + curveHeight);
-}
-
-double QExploratorySlider::evaluateCurve(double x, QPointF p1, QPointF p2, double e) const
-{
-    // Get the signed width and height
-    double w = p2.x() - p1.x();
-    double h = p2.y() - p1.y();
-
-    // Find the distance in x from point 1
-    double d = abs((p1.x() - x) / w);
-
-    // Compute the power function
-    double f = qPow(d, e);
-
-    // Map to y
-    return p1.y() + f * h; 
-}
-
-double QExploratorySlider::evaluateCurveInverse(double y, QPointF p1, QPointF p2, double e) const
-{
-    // Get the signed width and height
-    double w = p2.x() - p1.x();
-    double h = p2.y() - p1.y();
-
-    // Find the distance in y from point 1
-    double d = abs((p1.y() - y) / h);
-
-    // Compute the power function
-    double f = qPow(d, e);
+    sliderPainter.drawValue(&painter, palette(), handle.x(), widgetYFromValue(value));
+    sliderPainter.drawHandle(&painter, palette(), handle.x());
 
-    // Map to x
-    return p1.x() + f * w; 
+    drawCoverage(&painter);
 }
\ No newline at end of file
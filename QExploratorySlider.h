@@ -16,39 +16,57 @@
 #define QEXPLORATORYSLIDER_H
 
 
-#include "QNonlinearSlider.h"
+#include "QCurveCoefficients.h"
+#include "QMappedSlider.h"
 
+#include <QFutureWatcher>
+#include <QVector>
 
-class QExploratorySlider : public QNonlinearSlider
+
+class QExploratorySlider : public QMappedSlider<QExploratoryMapping>
 {
     Q_OBJECT
 
 public:
     QExploratorySlider(QWidget* parent = 0);
+    virtual ~QExploratorySlider();
 
     double getExponent();
     double getPivotValue();
 
+    // Accuracy used for evaluating the power functions
+    QPowAccuracy getAccuracy() const;
+    void setAccuracy(QPowAccuracy accuracy);
+
+    // The current curve and range, for evaluating in a shader
+    QCurveCoefficients getCoefficients() const;
+
+    virtual void beginTransaction();
+    virtual void endTransaction();
+
+    // Whether a fitToData() is running
+    bool isFitting() const;
+
 public slots:
     void setExponent(double e);
     void setPivotValue(double pv);
 
+    // Finds the exponent and pivot value whose curve best matches the
+    // distribution of the data index, so slider travel follows the data, and
+    // applies them when done.  The search runs on worker threads over a
+    // subsampled distribution, so it takes the same time for any data size.
+    void fitToData();
+    void cancelFit();
+
 signals:
     void exponentChanged(double v);
     void pivotValueChanged(double pv);
 
-protected:
-    // Exponent for power function
-    double exponent;
-
-    // Pivot value for curve, normalized to [0, 1]
-    double pivotValue;  
-
-    // Positions of curve points, in normalized coordinates
-    QPointF curvePoint1;
-    QPointF curvePoint2;
-    QPointF curvePoint3;
+    // Progress of fitToData(), in percent, and its end
+    void fitProgress(int percent);
+    void fitFinished();
 
+protected:
     // Size of drawn pivot value, in pixels
     double pivotRadius;
 
@@ -60,20 +78,47 @@ protected:
     };
     QExploratorySliderAction action;
 
+    // Exponent and pivot value before the outermost beginTransaction()
+    double transactionExponent;
+    double transactionPivotValue;
+
+    // Best exponent and pivot value found for one grid row, and the squared
+    // error of their curve
+    struct FitResult {
+        double error;
+        double exponent;
+        double pivotValue;
+    };
+
+    // Evaluates one grid row
+    struct FitRow;
+
+    // Distribution to fit, as normalized values at evenly spaced positions
+    QVector<double> fitQuantiles;
+
+    // Current search box, with the exponent as a base 2 logarithm, and round
+    double fitLogExponentMin;
+    double fitLogExponentMax;
+    double fitPivotMin;
+    double fitPivotMax;
+    int fitRound;
+
+    QFutureWatcher<FitResult> fitWatcher;
+
+protected slots:
+    void fitRowsProgressed(int rows);
+    void fitRoundFinished();
+
+protected:
     // Internal methods
+    void startFitRound();
+
     virtual void paintEvent(QPaintEvent* event);
 
     void mousePressEvent(QMouseEvent* event);
     void mouseDoubleClickEvent(QMouseEvent* event);
     void mouseReleaseEvent(QMouseEvent* event);
     void mouseMoveEvent(QMouseEvent* event);
-    
-    double widgetXFromValue(double v) const;
-    double valueFromWidgetX(double x) const;
-
-    void buildCurve();
-    double evaluateCurve(double x, QPointF p1, QPointF p2, double e) const;
-    double evaluateCurveInverse(double y, QPointF p1, QPointF p2, double e) const;
 };
 
 
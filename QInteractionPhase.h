@@ -0,0 +1,45 @@
+/*=========================================================================
+
+  Name:        QInteractionPhase.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Phase of the interaction a value update belongs to, carried
+               by the widgets' valueUpdated() and valuesUpdated() signals
+               along with a sequence number, so consumers can draw cheap
+               previews while the user drags and do one full-quality pass
+               at the end.
+
+               A drag gives one Begin update with the starting value, any
+               number of Preview updates, and one Final update with the
+               value it ended on, which may equal the last preview.  Values
+               set programmatically give a single Final update, unless set
+               with a phase, e.g. through setValue(double,
+               QInteractionPhase) connected to another widget's
+               valueUpdated().  Widgets linked that way pass the drag's
+               phases on, so each sees one Begin and one Final too.
+               Sequence numbers increase with each update of a widget, but
+               may skip.
+
+=========================================================================*/
+
+
+#ifndef QINTERACTIONPHASE_H
+#define QINTERACTIONPHASE_H
+
+
+#include <QMetaType>
+
+
+enum QInteractionPhase {
+    QInteractionBegin,
+    QInteractionPreview,
+    QInteractionFinal
+};
+
+Q_DECLARE_METATYPE(QInteractionPhase)
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,153 @@
+/*=========================================================================
+
+  Name:        QMappedSlider.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A QNonlinearSlider whose mapping from slider position to
+               data value is given as a compile-time policy (see
+               QNonlinearMapping.h).  The per-pixel curve sampling and the
+               value/position conversions call the policy directly, so
+               the compiler can inline them instead of going through
+               virtual calls for every sample.
+
+               Templates cannot contain Q_OBJECT, so subclasses that add
+               signals or slots (e.g. QPowerSlider) derive from a specific
+               instantiation and declare Q_OBJECT themselves.
+
+=========================================================================*/
+
+
+#ifndef QMAPPEDSLIDER_H
+#define QMAPPEDSLIDER_H
+
+
+#include "QNonlinearSlider.h"
+#include "QNonlinearMapping.h"
+#include "QScientificRepaintScheduler.h"
+
+#include <QMouseEvent>
+#include <QPolygonF>
+
+
+template <class Mapping>
+class QMappedSlider : public QNonlinearSlider
+{
+public:
+    QMappedSlider(QWidget* parent = 0)
+        : QNonlinearSlider(parent), moveHandle(false)
+    {
+    }
+
+    const Mapping& getMapping() const
+    {
+        return mapping;
+    }
+
+    virtual void getLookupTable(float* table, int size) const
+    {
+        for (int i = 0; i < size; i++) {
+            double x = size > 1 ? (double)i / (size - 1) : 0.0;
+
+            table[i] = mapping.yFromX(x);
+        }
+    }
+
+protected:
+    // The mapping policy
+    Mapping mapping;
+
+    // Default interaction is just moving the handle
+    bool moveHandle;
+
+    // Internal methods
+    virtual void mousePressEvent(QMouseEvent* event)
+    {
+        // Only care about left-button presses
+        if (event->button() != Qt::LeftButton) {
+            event->ignore();
+
+            return;
+        }
+
+        event->accept();
+
+        // Make sure the handle is up to date
+        ensureGeometry();
+
+        // Intersect with handle
+        QPointF d = event->pos() - pixelsFromWidget(handle);
+
+        moveHandle = qSqrt(d.x() * d.x() + d.y() * d.y()) <= handleRadius;
+
+        setDragging(moveHandle);
+
+        // Save mouse and handle positions
+        oldMousePosition = event->pos();
+        oldHandlePosition = handle;
+    }
+
+    virtual void mouseReleaseEvent(QMouseEvent* event)
+    {
+        if (!moveHandle) {
+            event->ignore();
+
+            return;
+        }
+
+        event->accept();
+
+        emit sliderReleased();
+
+        moveHandle = false;
+
+        // Back to full quality
+        setDragging(false);
+    }
+
+    virtual void mouseMoveEvent(QMouseEvent* event)
+    {
+        if (!moveHandle) {
+            event->ignore();
+
+            return;
+        }
+
+        event->accept();
+
+        // Move handle
+        handle.setX(qBound(0.0, oldHandlePosition.x() + (double)(event->pos().x() - oldMousePosition.x()) / width(), 1.0));
+
+        // Update value
+        setValueFromHandle();
+
+        // Save the mouse and widget positions
+        oldMousePosition = event->pos();
+        oldHandlePosition = handle;
+
+        // Repaint
+        QScientificRepaintScheduler::schedule(this);
+    }
+
+    virtual double widgetXFromValue(double v) const
+    {
+        return mapping.xFromY((v - minimum) / (maximum - minimum));
+    }
+
+    virtual double valueFromWidgetX(double x) const
+    {
+        return minimum + mapping.yFromX(x) * (maximum - minimum);
+    }
+
+    virtual void sampleCurve(QPolygonF& curve) const
+    {
+        // Widget y of a value mapped from widget x is just the normalized mapping,
+        // so skip the round trip through value space
+        getSliderPainter().sampleCurve(mapping, curve, curveSampleStep());
+    }
+};
+
+
+#endif
\ No newline at end of file
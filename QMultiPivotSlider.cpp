@@ -0,0 +1,359 @@
+/*=========================================================================
+
+  Name:        QMultiPivotSlider.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A widget that enables controlling the output of a slider
+               via a piecewise power function with any number of pivots,
+               giving fine precision around several data values at once.
+
+=========================================================================*/
+
+
+#include "QMultiPivotSlider.h"
+
+#include "QScientificRepaintScheduler.h"
+
+#include <QtCore/qmath.h>
+#include <QMouseEvent>
+#include <QPainter>
+
+
+QMultiPivotSlider::QMultiPivotSlider(QWidget* parent)
+    : QMappedSlider<QMultiPivotMapping>(parent)
+{
+    // No interaction to start with
+    action = QMultiPivotSliderNoAction;
+
+    // Pivot values may be queued to another thread
+    qRegisterMetaType<QVector<double> >("QVector<double>");
+
+    // Appearance
+    pivotRadius = 1.5;
+}
+
+
+double QMultiPivotSlider::getExponent() const
+{
+    return mapping.getExponent();
+}
+
+
+void QMultiPivotSlider::setExponent(double e)
+{
+    if (e == mapping.getExponent()) {
+        return;
+    }
+
+    mapping.setExponent(e);
+
+    // Curve and handle need updating
+    invalidateCurve();
+
+    // Emit the exponent as a signal
+    emit exponentChanged(mapping.getExponent());
+    emit curveChanged();
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QVector<double> QMultiPivotSlider::getPivotValues() const
+{
+    return mapping.getPivotValues();
+}
+
+
+void QMultiPivotSlider::setPivotValues(const QVector<double>& pv)
+{
+    QVector<double> old = mapping.getPivotValues();
+
+    mapping.setPivotValues(pv);
+
+    if (mapping.getPivotValues() == old) {
+        return;
+    }
+
+    // Curve and handle need updating
+    invalidateCurve();
+
+    // Emit the pivot values as a signal
+    emit pivotValuesChanged(mapping.getPivotValues());
+    emit curveChanged();
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+void QMultiPivotSlider::addPivotValue(double pv)
+{
+    QVector<double> pivotValues = mapping.getPivotValues();
+    pivotValues.append(pv);
+
+    setPivotValues(pivotValues);
+}
+
+void QMultiPivotSlider::clearPivotValues()
+{
+    setPivotValues(QVector<double>());
+}
+
+
+QPowAccuracy QMultiPivotSlider::getAccuracy() const
+{
+    return mapping.getAccuracy();
+}
+
+
+void QMultiPivotSlider::setAccuracy(QPowAccuracy accuracy)
+{
+    if (accuracy == mapping.getAccuracy()) {
+        return;
+    }
+
+    mapping.setAccuracy(accuracy);
+
+    // Curve and handle need updating
+    invalidateCurve();
+
+    emit curveChanged();
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+void QMultiPivotSlider::getLookupTable(float* table, int size) const
+{
+    // Positions are sorted, so the mapping steps through the segments in order
+    for (int i = 0; i < size; i++) {
+        table[i] = size > 1 ? (float)i / (size - 1) : 0.0f;
+    }
+
+    mapping.yFromX(table, table, size);
+}
+
+
+void QMultiPivotSlider::beginTransaction()
+{
+    if (transactionDepth == 0) {
+        transactionExponent = mapping.getExponent();
+        transactionPivotValues = mapping.getPivotValues();
+    }
+
+    QNonlinearSlider::beginTransaction();
+}
+
+void QMultiPivotSlider::endTransaction()
+{
+    bool outermost = transactionDepth == 1;
+
+    QNonlinearSlider::endTransaction();
+
+    if (!outermost) {
+        return;
+    }
+
+    if (mapping.getExponent() != transactionExponent) {
+        emit exponentChanged(mapping.getExponent());
+    }
+
+    if (mapping.getPivotValues() != transactionPivotValues) {
+        emit pivotValuesChanged(mapping.getPivotValues());
+    }
+
+    if (mapping.getExponent() != transactionExponent || mapping.getPivotValues() != transactionPivotValues) {
+        emit curveChanged();
+    }
+}
+
+
+void QMultiPivotSlider::mousePressEvent(QMouseEvent* event)
+{
+    // Only care about left-button presses
+    if (event->button() != Qt::LeftButton) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    // Get the event position
+    QPoint p = event->pos();
+
+    // Map to range
+    p.setX(qBound(0, p.x(), width()));
+    p.setY(qBound(0, p.y(), height()));
+
+    // Make sure the handle is up to date
+    ensureGeometry();
+
+    // Intersect with controls
+    action = QMultiPivotSliderNoAction;
+
+    QPointF d = p - pixelsFromWidget(handle);
+
+    if (qSqrt(d.x() * d.x() + d.y() * d.y()) <= handleRadius) {
+        action = QMultiPivotSliderMoveHandle;
+
+        oldHandlePosition = handle;
+    }
+    else {
+        action = QMultiPivotSliderChangeExponent;
+    }
+
+    setDragging(true);
+
+    // Save mouse position
+    oldMousePosition = p;
+}
+
+
+void QMultiPivotSlider::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    // Only care about left- and right-button presses
+    if (event->button() != Qt::LeftButton &&
+        event->button() != Qt::RightButton) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    switch (event->button()) {
+
+        case Qt::LeftButton:
+
+            // Add a pivot at the current value
+            addPivotValue(widgetYFromValue(value));
+
+            break;
+
+        case Qt::RightButton:
+
+            // Reset exponent and pivots
+            setExponent(1.0);
+            clearPivotValues();
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+void QMultiPivotSlider::mouseReleaseEvent(QMouseEvent* event)
+{
+    // Check action variable
+    if (action == QMultiPivotSliderNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    if (action == QMultiPivotSliderMoveHandle) {
+        emit sliderReleased();
+    }
+
+    // Clear action variable
+    action = QMultiPivotSliderNoAction;
+
+    // Back to full quality
+    setDragging(false);
+}
+
+
+void QMultiPivotSlider::mouseMoveEvent(QMouseEvent* event)
+{
+    // Check action variable
+    if (action == QMultiPivotSliderNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    // Get the delta between the last event and here
+    QPoint delta = event->pos() - oldMousePosition;
+    delta.setY(-delta.y());
+
+    // Save the mouse position
+    oldMousePosition = event->pos();
+
+    switch (action) {
+
+        case QMultiPivotSliderMoveHandle:
+            // Move handle
+            handle.setX(qBound(0.0, oldHandlePosition.x() + (double)delta.x() / width(), 1.0));
+
+            // Update value
+            setValueFromHandle();
+
+            break;
+
+        case QMultiPivotSliderChangeExponent:
+            if (delta.y() < 0) {
+                // Increase exponent
+                setExponent(mapping.getExponent() * 1.1);
+            }
+            else if (delta.y() > 0) {
+                // Decrease exponent
+                setExponent(mapping.getExponent() / 1.1);
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    // Save the widget position
+    oldHandlePosition = handle;
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+void QMultiPivotSlider::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+
+
+    // Positions and sizes may need to change
+    ensureGeometry();
+
+
+    // Draw
+    QNonlinearSliderPainter sliderPainter = getSliderPainter();
+    sliderPainter.setPivotRadius(pivotRadius);
+
+    sliderPainter.drawBorder(&painter, palette());
+    drawTicks(&painter);
+    sliderPainter.drawCurve(&painter, palette(), curve);
+
+    // Skip decorations while dragging at reduced quality
+    if (renderQuality() == FullQuality) {
+        // The curve meets the diagonal at each pivot
+        const QVector<double>& pivotValues = mapping.getPivotValues();
+
+        for (int i = 0; i < pivotValues.size(); i++) {
+            sliderPainter.drawPivot(&painter, palette(), pivotValues[i], pivotValues[i]);
+        }
+    }
+
+    sliderPainter.drawValue(&painter, palette(), handle.x(), widgetYFromValue(value));
+    sliderPainter.drawHandle(&painter, palette(), handle.x());
+
+    drawCoverage(&painter);
+}
\ No newline at end of file
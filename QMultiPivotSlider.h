@@ -0,0 +1,84 @@
+/*=========================================================================
+
+  Name:        QMultiPivotSlider.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A widget that enables controlling the output of a slider
+               via a piecewise power function with any number of pivots,
+               giving fine precision around several data values at once.
+
+=========================================================================*/
+
+
+#ifndef QMULTIPIVOTSLIDER_H
+#define QMULTIPIVOTSLIDER_H
+
+
+#include "QMappedSlider.h"
+#include "QScientificMetaTypes.h"
+
+#include <QVector>
+
+
+class QMultiPivotSlider : public QMappedSlider<QMultiPivotMapping>
+{
+    Q_OBJECT
+
+public:
+    QMultiPivotSlider(QWidget* parent = 0);
+
+    double getExponent() const;
+
+    // Pivot values, sorted and normalized to [0, 1]
+    QVector<double> getPivotValues() const;
+    void setPivotValues(const QVector<double>& pv);
+
+    // Accuracy used for evaluating the power functions
+    QPowAccuracy getAccuracy() const;
+    void setAccuracy(QPowAccuracy accuracy);
+
+    virtual void getLookupTable(float* table, int size) const;
+
+    virtual void beginTransaction();
+    virtual void endTransaction();
+
+public slots:
+    void setExponent(double e);
+
+    void addPivotValue(double pv);
+    void clearPivotValues();
+
+signals:
+    void exponentChanged(double e);
+    void pivotValuesChanged(const QVector<double>& pv);
+
+protected:
+    // Size of drawn pivot values, in pixels
+    double pivotRadius;
+
+    // Interaction states
+    enum QMultiPivotSliderAction {
+        QMultiPivotSliderNoAction,
+        QMultiPivotSliderMoveHandle,
+        QMultiPivotSliderChangeExponent
+    };
+    QMultiPivotSliderAction action;
+
+    // Exponent and pivot values before the outermost beginTransaction()
+    double transactionExponent;
+    QVector<double> transactionPivotValues;
+
+    // Internal methods
+    virtual void paintEvent(QPaintEvent* event);
+
+    void mousePressEvent(QMouseEvent* event);
+    void mouseDoubleClickEvent(QMouseEvent* event);
+    void mouseReleaseEvent(QMouseEvent* event);
+    void mouseMoveEvent(QMouseEvent* event);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,518 @@
+/*=========================================================================
+
+  Name:        QMultiSliderPanel.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A single widget holding many power or exploratory sliders,
+               one per row, e.g. one transfer curve per channel.  Channel
+               parameters are stored as parallel arrays, and only rows
+               intersecting the paint region are drawn, so the cost of
+               painting scales with the number of visible rows.
+
+=========================================================================*/
+
+
+#include "QMultiSliderPanel.h"
+
+#include "QNonlinearMapping.h"
+#include "QNonlinearSliderPainter.h"
+#include "QScientificRepaintScheduler.h"
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QPolygonF>
+
+
+QMultiSliderPanel::QMultiSliderPanel(QWidget* parent)
+    : QWidget(parent)
+{
+    accuracy = QPowExact;
+
+    // Appearance
+    handleRadius = 7;
+    valueRadius = handleRadius / 2;
+    pivotRadius = 1.5;
+
+    rowHeight = handleRadius * 4;
+
+    borderX = handleRadius + 1;
+    borderY = valueRadius + 1;
+
+    // No interaction to start with
+    action = QMultiSliderPanelNoAction;
+    activeChannel = -1;
+    oldHandleX = 0.0;
+}
+
+
+int QMultiSliderPanel::getChannelCount() const
+{
+    return values.size();
+}
+
+void QMultiSliderPanel::setChannelCount(int count, MappingType type)
+{
+    count = qMax(count, 0);
+
+    int oldCount = values.size();
+
+    values.resize(count);
+    minimums.resize(count);
+    maximums.resize(count);
+    exponents.resize(count);
+    pivotValues.resize(count);
+    mappingTypes.resize(count);
+
+    // Defaults for new channels
+    for (int i = oldCount; i < count; i++) {
+        values[i] = 0.5;
+        minimums[i] = 0.0;
+        maximums[i] = 1.0;
+        exponents[i] = 1.0;
+        pivotValues[i] = 0.5;
+        mappingTypes[i] = type;
+    }
+
+    if (activeChannel >= count) {
+        action = QMultiSliderPanelNoAction;
+        activeChannel = -1;
+    }
+
+    updateGeometry();
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QMultiSliderPanel::MappingType QMultiSliderPanel::getMappingType(int channel) const
+{
+    return (MappingType)mappingTypes.value(channel, PowerMapping);
+}
+
+void QMultiSliderPanel::setMappingType(int channel, MappingType type)
+{
+    if (!isChannel(channel)) {
+        return;
+    }
+
+    if (type == mappingTypes[channel]) {
+        return;
+    }
+
+    mappingTypes[channel] = type;
+
+    updateRow(channel);
+}
+
+
+double QMultiSliderPanel::getValue(int channel) const
+{
+    return values.value(channel);
+}
+
+double QMultiSliderPanel::getMinimum(int channel) const
+{
+    return minimums.value(channel);
+}
+
+double QMultiSliderPanel::getMaximum(int channel) const
+{
+    return maximums.value(channel);
+}
+
+double QMultiSliderPanel::getExponent(int channel) const
+{
+    return exponents.value(channel);
+}
+
+double QMultiSliderPanel::getPivotValue(int channel) const
+{
+    return pivotValues.value(channel);
+}
+
+
+void QMultiSliderPanel::setValue(int channel, double v)
+{
+    if (!isChannel(channel)) {
+        return;
+    }
+
+    v = qBound(minimums[channel], v, maximums[channel]);
+
+    if (v == values[channel]) {
+        return;
+    }
+
+    values[channel] = v;
+
+    // Emit the value as a signal
+    emit valueChanged(channel, v);
+
+    // Repaint just this row
+    updateRow(channel);
+}
+
+void QMultiSliderPanel::setRange(int channel, double min, double max)
+{
+    if (!isChannel(channel)) {
+        return;
+    }
+
+    double oldMin = minimums[channel];
+    double oldMax = maximums[channel];
+
+    minimums[channel] = qMin(min, max);
+    maximums[channel] = qMax(min, max);
+
+    if (oldMin != minimums[channel] || oldMax != maximums[channel]) {
+        // Ensure valid value
+        setValue(channel, values[channel]);
+
+        // Repaint just this row
+        updateRow(channel);
+    }
+}
+
+void QMultiSliderPanel::setExponent(int channel, double e)
+{
+    if (!isChannel(channel)) {
+        return;
+    }
+
+    if (e == exponents[channel]) {
+        return;
+    }
+
+    exponents[channel] = e;
+
+    // Emit the exponent as a signal
+    emit exponentChanged(channel, e);
+
+    // Repaint just this row
+    updateRow(channel);
+}
+
+void QMultiSliderPanel::setPivotValue(int channel, double pv)
+{
+    if (!isChannel(channel)) {
+        return;
+    }
+
+    if (pv == pivotValues[channel]) {
+        return;
+    }
+
+    pivotValues[channel] = pv;
+
+    // Emit the pivot value as a signal
+    emit pivotValueChanged(channel, pv);
+
+    // Repaint just this row
+    updateRow(channel);
+}
+
+
+void QMultiSliderPanel::setAccuracy(QPowAccuracy accuracy)
+{
+    if (accuracy == this->accuracy) {
+        return;
+    }
+
+    this->accuracy = accuracy;
+
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+int QMultiSliderPanel::getRowHeight() const
+{
+    return rowHeight;
+}
+
+void QMultiSliderPanel::setRowHeight(int height)
+{
+    rowHeight = qMax(height, valueRadius * 2 + 3);
+
+    updateGeometry();
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+bool QMultiSliderPanel::isChannel(int channel) const
+{
+    return channel >= 0 && channel < values.size();
+}
+
+
+int QMultiSliderPanel::channelAt(int y) const
+{
+    if (y < 0) {
+        return -1;
+    }
+
+    // Rows are uniform, so just divide
+    int channel = y / rowHeight;
+
+    return channel < values.size() ? channel : -1;
+}
+
+
+QSize QMultiSliderPanel::sizeHint() const
+{
+    int h = handleRadius * 6;
+
+    return QSize(h * 3, rowHeight * values.size());
+}
+
+QSize QMultiSliderPanel::minimumSizeHint() const
+{
+    int h = handleRadius * 4;
+
+    return QSize(h * 3, rowHeight * values.size());
+}
+
+
+void QMultiSliderPanel::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+
+    // Only draw rows intersecting the region to paint
+    QRect r = event->rect();
+
+    int first = qMax(0, r.top() / rowHeight);
+    int last = qMin(values.size() - 1, r.bottom() / rowHeight);
+
+    for (int i = first; i <= last; i++) {
+        paintRow(painter, i);
+    }
+}
+
+void QMultiSliderPanel::paintRow(QPainter& painter, int channel)
+{
+    QNonlinearSliderPainter sliderPainter = getSliderPainter(channel);
+    sliderPainter.setPivotRadius(pivotRadius);
+
+    // Sample the curve for this row
+    QPolygonF curve;
+
+    bool exploratory = mappingTypes[channel] == ExploratoryMapping;
+
+    if (exploratory) {
+        sliderPainter.sampleCurve(QExploratoryMapping(exponents[channel], pivotValues[channel], accuracy), curve);
+    }
+    else {
+        sliderPainter.sampleCurve(QPowerMapping(exponents[channel], accuracy), curve);
+    }
+
+    // Handle position, which is the source of truth while dragging
+    double handleX = channel == activeChannel && action == QMultiSliderPanelMoveHandle ?
+                     oldHandleX : widgetXFromValue(channel, values[channel]);
+
+    double valueY = (values[channel] - minimums[channel]) / (maximums[channel] - minimums[channel]);
+
+    // Draw
+    if (exploratory) {
+        sliderPainter.drawBackground(&painter, palette());
+    }
+
+    sliderPainter.drawBorder(&painter, palette());
+    sliderPainter.drawCurve(&painter, palette(), curve);
+
+    if (exploratory) {
+        double pv = pivotValues[channel];
+
+        sliderPainter.drawPivot(&painter, palette(), QExploratoryMapping(exponents[channel], pv, accuracy).xFromY(pv), pv);
+    }
+
+    sliderPainter.drawValue(&painter, palette(), handleX, valueY);
+    sliderPainter.drawHandle(&painter, palette(), handleX);
+}
+
+
+void QMultiSliderPanel::mousePressEvent(QMouseEvent* event)
+{
+    // Only care about left-button presses
+    if (event->button() != Qt::LeftButton) {
+        event->ignore();
+
+        return;
+    }
+
+    // Find the row
+    int channel = channelAt(event->pos().y());
+
+    if (channel < 0) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    activeChannel = channel;
+
+    // Intersect with the handle of this row
+    double handleX = widgetXFromValue(channel, values[channel]);
+
+    if (getSliderPainter(channel).handleContains(handleX, event->pos())) {
+        action = QMultiSliderPanelMoveHandle;
+
+        oldHandleX = handleX;
+    }
+    else {
+        action = QMultiSliderPanelChangeExponent;
+    }
+
+    // Save mouse position
+    oldMousePosition = event->pos();
+}
+
+
+void QMultiSliderPanel::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    int channel = channelAt(event->pos().y());
+
+    // Only care about left- and right-button presses on exploratory rows
+    if (channel < 0 || mappingTypes[channel] != ExploratoryMapping ||
+        (event->button() != Qt::LeftButton &&
+         event->button() != Qt::RightButton)) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    if (event->button() == Qt::LeftButton) {
+        // Set the pivot value
+        setPivotValue(channel, (values[channel] - minimums[channel]) / (maximums[channel] - minimums[channel]));
+    }
+    else {
+        // Reset exponent and pivot
+        setExponent(channel, 1.0);
+        setPivotValue(channel, 0.5);
+    }
+}
+
+
+void QMultiSliderPanel::mouseReleaseEvent(QMouseEvent* event)
+{
+    // Check action variable
+    if (action == QMultiSliderPanelNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    int channel = activeChannel;
+
+    // Clear action variable
+    bool moveHandle = action == QMultiSliderPanelMoveHandle;
+
+    action = QMultiSliderPanelNoAction;
+    activeChannel = -1;
+
+    if (moveHandle) {
+        emit sliderReleased(channel);
+    }
+
+    updateRow(channel);
+}
+
+
+void QMultiSliderPanel::mouseMoveEvent(QMouseEvent* event)
+{
+    // Check action variable
+    if (action == QMultiSliderPanelNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    // Get the delta between the last event and here
+    QPoint delta = event->pos() - oldMousePosition;
+    delta.setY(-delta.y());
+
+    // Save the mouse position
+    oldMousePosition = event->pos();
+
+    switch (action) {
+
+        case QMultiSliderPanelMoveHandle:
+            // Move handle
+            oldHandleX = qBound(0.0, oldHandleX + (double)delta.x() / width(), 1.0);
+
+            // Update value
+            setValue(activeChannel, valueFromWidgetX(activeChannel, oldHandleX));
+
+            break;
+
+        case QMultiSliderPanelChangeExponent:
+            if (delta.y() < 0) {
+                // Increase exponent
+                setExponent(activeChannel, exponents[activeChannel] * 1.1);
+            }
+            else if (delta.y() > 0) {
+                // Decrease exponent
+                setExponent(activeChannel, exponents[activeChannel] / 1.1);
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    // Repaint
+    updateRow(activeChannel);
+}
+
+
+double QMultiSliderPanel::widgetXFromValue(int channel, double v) const
+{
+    double y = (v - minimums[channel]) / (maximums[channel] - minimums[channel]);
+
+    if (mappingTypes[channel] == ExploratoryMapping) {
+        return QExploratoryMapping(exponents[channel], pivotValues[channel], accuracy).xFromY(y);
+    }
+    else {
+        return QPowerMapping(exponents[channel], accuracy).xFromY(y);
+    }
+}
+
+double QMultiSliderPanel::valueFromWidgetX(int channel, double x) const
+{
+    double y;
+
+    if (mappingTypes[channel] == ExploratoryMapping) {
+        y = QExploratoryMapping(exponents[channel], pivotValues[channel], accuracy).yFromX(x);
+    }
+    else {
+        y = QPowerMapping(exponents[channel], accuracy).yFromX(x);
+    }
+
+    return minimums[channel] + y * (maximums[channel] - minimums[channel]);
+}
+
+
+void QMultiSliderPanel::updateRow(int channel)
+{
+    QScientificRepaintScheduler::schedule(this, rowRect(channel));
+}
+
+QRect QMultiSliderPanel::rowRect(int channel) const
+{
+    return QRect(0, channel * rowHeight, width(), rowHeight);
+}
+
+QNonlinearSliderPainter QMultiSliderPanel::getSliderPainter(int channel) const
+{
+    return QNonlinearSliderPainter(rowRect(channel), handleRadius, valueRadius, borderX, borderY);
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+/*=========================================================================
+
+  Name:        QMultiSliderPanel.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A single widget holding many power or exploratory sliders,
+               one per row, e.g. one transfer curve per channel.  Channel
+               parameters are stored as parallel arrays, and only rows
+               intersecting the paint region are drawn, so the cost of
+               painting scales with the number of visible rows.
+
+=========================================================================*/
+
+
+#ifndef QMULTISLIDERPANEL_H
+#define QMULTISLIDERPANEL_H
+
+
+#include <QWidget>
+#include <QVector>
+
+#include "QFastMath.h"
+
+class QNonlinearSliderPainter;
+
+
+class QMultiSliderPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // Mapping used for a channel
+    enum MappingType {
+        PowerMapping,
+        ExploratoryMapping
+    };
+
+    QMultiSliderPanel(QWidget* parent = 0);
+
+    int getChannelCount() const;
+    void setChannelCount(int count, MappingType type = ExploratoryMapping);
+
+    // Out-of-range channels are ignored by setters, and give 0 from getters
+    MappingType getMappingType(int channel) const;
+    void setMappingType(int channel, MappingType type);
+
+    double getValue(int channel) const;
+    double getMinimum(int channel) const;
+    double getMaximum(int channel) const;
+    double getExponent(int channel) const;
+    double getPivotValue(int channel) const;
+
+    void setRange(int channel, double min, double max);
+
+    void setAccuracy(QPowAccuracy accuracy);
+
+    // Height of each row, in pixels
+    int getRowHeight() const;
+    void setRowHeight(int height);
+
+    // Returns the channel at the given widget y position, or -1
+    int channelAt(int y) const;
+
+    virtual QSize sizeHint() const;
+    virtual QSize minimumSizeHint() const;
+
+public slots:
+    void setValue(int channel, double v);
+    void setExponent(int channel, double e);
+    void setPivotValue(int channel, double pv);
+
+signals:
+    void valueChanged(int channel, double v);
+    void exponentChanged(int channel, double e);
+    void pivotValueChanged(int channel, double pv);
+    void sliderReleased(int channel);
+
+protected:
+    // Channel parameters, stored as parallel arrays
+    QVector<double> values;
+    QVector<double> minimums;
+    QVector<double> maximums;
+    QVector<double> exponents;
+    QVector<double> pivotValues;
+    QVector<uchar> mappingTypes;
+
+    // Accuracy of the power functions
+    QPowAccuracy accuracy;
+
+    // Size of rows and drawn elements, in pixels
+    int rowHeight;
+    int handleRadius;
+    int valueRadius;
+    double pivotRadius;
+
+    // Border from edge of each row
+    int borderX;
+    int borderY;
+
+    // Interaction states
+    enum QMultiSliderPanelAction {
+        QMultiSliderPanelNoAction,
+        QMultiSliderPanelMoveHandle,
+        QMultiSliderPanelChangeExponent
+    };
+    QMultiSliderPanelAction action;
+
+    // Mouse interaction variables
+    int activeChannel;
+    QPoint oldMousePosition;
+    double oldHandleX;
+
+    // Internal methods
+    virtual void paintEvent(QPaintEvent* event);
+
+    virtual void mousePressEvent(QMouseEvent* event);
+    virtual void mouseDoubleClickEvent(QMouseEvent* event);
+    virtual void mouseReleaseEvent(QMouseEvent* event);
+    virtual void mouseMoveEvent(QMouseEvent* event);
+
+    bool isChannel(int channel) const;
+
+    void paintRow(QPainter& painter, int channel);
+
+    double widgetXFromValue(int channel, double v) const;
+    double valueFromWidgetX(int channel, double x) const;
+
+    void updateRow(int channel);
+    QRect rowRect(int channel) const;
+
+    // Returns a painter for drawing the given row
+    QNonlinearSliderPainter getSliderPainter(int channel) const;
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,834 @@
+/*=========================================================================
+
+  Name:        QNonlinearMapping.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Mapping policies used by QMappedSlider to map normalized
+               slider position to normalized data value.
+
+               A mapping is any class providing the two inline methods
+
+                   double yFromX(double x) const;
+                   double xFromY(double y) const;
+
+               where x is the normalized slider position and y is the
+               normalized data value, both in [0, 1].  The mappings have
+               no dependency on QWidget, so they can also be used to
+               apply a curve to data outside of the GUI.
+
+=========================================================================*/
+
+
+#ifndef QNONLINEARMAPPING_H
+#define QNONLINEARMAPPING_H
+
+
+#include "QFastMath.h"
+
+#include <QPointF>
+#include <QVector>
+
+#include <algorithm>
+
+
+// Identity mapping
+class QLinearMapping
+{
+public:
+    double yFromX(double x) const
+    {
+        return x;
+    }
+
+    double xFromY(double y) const
+    {
+        return y;
+    }
+};
+
+
+// Single power function, as used by QPowerSlider
+class QPowerMapping
+{
+public:
+    QPowerMapping()
+        : exponent(1.0), accuracy(QPowExact)
+    {
+    }
+
+    QPowerMapping(double e, QPowAccuracy a = QPowExact)
+        : exponent(e), accuracy(a)
+    {
+    }
+
+    double getExponent() const
+    {
+        return exponent;
+    }
+
+    void setExponent(double e)
+    {
+        exponent = e;
+    }
+
+    QPowAccuracy getAccuracy() const
+    {
+        return accuracy;
+    }
+
+    void setAccuracy(QPowAccuracy a)
+    {
+        accuracy = a;
+    }
+
+    double yFromX(double x) const
+    {
+        if (exponent < 1.0) {
+            // Instead of using an exponent < 1.0, flip the curve to flatten out curve horizontally near 1.0
+            return 1.0 - qPow(1.0 - x, 1.0 / exponent, accuracy);
+        }
+        else {
+            return qPow(x, exponent, accuracy);
+        }
+    }
+
+    double xFromY(double y) const
+    {
+        if (exponent < 1.0) {
+            // Instead of using an exponent < 1.0, flip the curve to flatten out curve horizontally near 1.0
+            return 1.0 - qPow(1.0 - y, exponent, accuracy);
+        }
+        else {
+            return qPow(y, 1.0 / exponent, accuracy);
+        }
+    }
+
+protected:
+    // Exponent for power function
+    double exponent;
+
+    // Accuracy of the power function
+    QPowAccuracy accuracy;
+};
+
+
+// Combination of two power functions meeting at a pivot, as used by QExploratorySlider
+class QExploratoryMapping
+{
+public:
+    QExploratoryMapping()
+        : exponent(1.0), pivotValue(0.5), accuracy(QPowExact)
+    {
+        buildCurve();
+    }
+
+    QExploratoryMapping(double e, double pv, QPowAccuracy a = QPowExact)
+        : exponent(e), pivotValue(pv), accuracy(a)
+    {
+        buildCurve();
+    }
+
+    double getExponent() const
+    {
+        return exponent;
+    }
+
+    double getPivotValue() const
+    {
+        return pivotValue;
+    }
+
+    void setExponent(double e)
+    {
+        exponent = e;
+
+        buildCurve();
+    }
+
+    void setPivotValue(double pv)
+    {
+        pivotValue = pv;
+
+        buildCurve();
+    }
+
+    QPowAccuracy getAccuracy() const
+    {
+        return accuracy;
+    }
+
+    void setAccuracy(QPowAccuracy a)
+    {
+        accuracy = a;
+    }
+
+    // Positions of curve points, in normalized coordinates
+    QPointF getCurvePoint1() const { return curvePoint1; }
+    QPointF getCurvePoint2() const { return curvePoint2; }
+    QPointF getCurvePoint3() const { return curvePoint3; }
+
+    double yFromX(double x) const
+    {
+        if (exponent < 1.0) {
+            double e = 1.0 / exponent;
+
+            if (x <= curvePoint2.x()) {
+                return evaluateCurve(x, curvePoint1, curvePoint2, e);
+            }
+            else {
+                return evaluateCurve(x, curvePoint3, curvePoint2, e);
+            }
+        }
+        else {
+            double e = exponent;
+
+            if (x <= curvePoint2.x()) {
+                return evaluateCurve(x, curvePoint2, curvePoint1, e);
+            }
+            else {
+                return evaluateCurve(x, curvePoint2, curvePoint3, e);
+            }
+        }
+    }
+
+    double xFromY(double y) const
+    {
+        if (exponent < 1.0) {
+            double e = 1.0 / exponent;
+
+            if (y <= curvePoint2.y()) {
+                return evaluateCurveInverse(y, curvePoint1, curvePoint2, 1.0 / e);
+            }
+            else {
+                return evaluateCurveInverse(y, curvePoint3, curvePoint2, 1.0 / e);
+            }
+        }
+        else {
+            double e = exponent;
+
+            if (y <= curvePoint2.y()) {
+                return evaluateCurveInverse(y, curvePoint2, curvePoint1, 1.0 / e);
+            }
+            else {
+                return evaluateCurveInverse(y, curvePoint2, curvePoint3, 1.0 / e);
+            }
+        }
+    }
+
+protected:
+    // Exponent for power function
+    double exponent;
+
+    // Pivot value for curve, normalized to [0, 1]
+    double pivotValue;
+
+    // Accuracy of the power function
+    QPowAccuracy accuracy;
+
+    // Positions of curve points, in normalized coordinates
+    QPointF curvePoint1;
+    QPointF curvePoint2;
+    QPointF curvePoint3;
+
+    void buildCurve()
+    {
+        // When exponent is greater than 1.0, we use two curves moving away from the pivot.
+        // When exponent is less than 1.0, we invert the exponent, but use two curves moving
+        // away from 0 and 1.  This enables flattening the values either at either side of the
+        // pivot, or from 0 or 1 to the pivot.  When exponent is less than 1.0, we also use
+        // 1.0 - pivot as the pivot value to make the curve longer.
+
+        bool invert = exponent < 1.0;
+
+        // The exponent and pivot value
+        double e = invert ? 1.0 / exponent : exponent;
+        double pv = invert ? 1.0 - pivotValue : pivotValue;
+
+        // Find the smallest distance from the pivot value to 0 or 1
+        double pivotDistance = qMin(pv, 1.0 - pv);
+
+        // Find the height of the curves
+        double curveHeight = 1.0 - pivotDistance;
+
+        // Find the x-intercept with the top or bottom
+        double intercept = invert ? 1.0 - qPow(1.0 - pivotDistance / curveHeight, 1.0 / e)
+                                  : qPow(pivotDistance / curveHeight, 1.0 / e);
+
+        // Find the x pivot position
+        double pivotX = pv <= 0.5 ? intercept : 1.0;
+        pivotX /= (1.0 + intercept);
+
+        // Find the width of the curves, based on the x pivot position
+        double curveWidth = qMax(pivotX, 1.0 - pivotX);
+
+        // Find the points of the curve
+        curvePoint1 = QPointF(pivotX - curveWidth, pv - curveHeight);
+        curvePoint2 = QPointF(pivotX, pv);
+        curvePoint3 = QPointF(pivotX + curveWidth, pv + curveHeight);
+    }
+
+    double evaluateCurve(double x, const QPointF& p1, const QPointF& p2, double e) const
+    {
+        // Get the signed width and height
+        double w = p2.x() - p1.x();
+        double h = p2.y() - p1.y();
+
+        // Find the distance in x from point 1
+        double d = qAbs((p1.x() - x) / w);
+
+        // Compute the power function
+        double f = qPow(d, e, accuracy);
+
+        // Map to y
+        return p1.y() + f * h;
+    }
+
+    double evaluateCurveInverse(double y, const QPointF& p1, const QPointF& p2, double e) const
+    {
+        // Get the signed width and height
+        double w = p2.x() - p1.x();
+        double h = p2.y() - p1.y();
+
+        // Find the distance in y from point 1
+        double d = qAbs((p1.y() - y) / h);
+
+        // Compute the power function
+        double f = qPow(d, e, accuracy);
+
+        // Map to x
+        return p1.x() + f * w;
+    }
+};
+
+
+// Piecewise power function with any number of pivots, as used by QMultiPivotSlider.
+//
+// The pivots split [0, 1] into segments, and each segment between two pivots is
+// split again at its midpoint.  Each piece is a power function that is flat at its
+// pivot end when the exponent is greater than 1.0, and flat at its other end when
+// it is less than 1.0, as with QExploratoryMapping.  Each piece is as wide as it is
+// high, so the curve meets the diagonal at every knot, and the same sorted knot
+// array bounds the pieces for both yFromX() and xFromY().  With no pivots this is
+// the same curve as QPowerMapping.
+class QMultiPivotMapping
+{
+public:
+    QMultiPivotMapping()
+        : exponent(1.0), accuracy(QPowExact)
+    {
+        buildCurve();
+    }
+
+    QMultiPivotMapping(double e, const QVector<double>& pv, QPowAccuracy a = QPowExact)
+        : exponent(e), accuracy(a)
+    {
+        setPivotValues(pv);
+    }
+
+    double getExponent() const
+    {
+        return exponent;
+    }
+
+    void setExponent(double e)
+    {
+        exponent = e;
+    }
+
+    // Pivot values, sorted and normalized to [0, 1]
+    const QVector<double>& getPivotValues() const
+    {
+        return pivotValues;
+    }
+
+    void setPivotValues(const QVector<double>& pv)
+    {
+        pivotValues.clear();
+
+        for (int i = 0; i < pv.size(); i++) {
+            pivotValues.append(qBound(0.0, pv[i], 1.0));
+        }
+
+        std::sort(pivotValues.begin(), pivotValues.end());
+        pivotValues.erase(std::unique(pivotValues.begin(), pivotValues.end()), pivotValues.end());
+
+        buildCurve();
+    }
+
+    QPowAccuracy getAccuracy() const
+    {
+        return accuracy;
+    }
+
+    void setAccuracy(QPowAccuracy a)
+    {
+        accuracy = a;
+    }
+
+    // Segment boundaries, sorted, from 0 to 1
+    const QVector<double>& getKnots() const
+    {
+        return knots;
+    }
+
+    double yFromX(double x) const
+    {
+        return evaluate(segment(x), x, false);
+    }
+
+    double xFromY(double y) const
+    {
+        return evaluate(segment(y), y, true);
+    }
+
+    // Map n values at once.  Sorted input steps from one segment to the next
+    // instead of searching for each value.
+    template <class T>
+    void yFromX(const T* x, T* y, int n) const
+    {
+        evaluate(x, y, n, false);
+    }
+
+    template <class T>
+    void xFromY(const T* y, T* x, int n) const
+    {
+        evaluate(y, x, n, true);
+    }
+
+protected:
+    // Exponent for power functions
+    double exponent;
+
+    // Sorted pivot values
+    QVector<double> pivotValues;
+
+    // Accuracy of the power functions
+    QPowAccuracy accuracy;
+
+    // Segment i spans knots[i] to knots[i + 1], and has its pivot at its start
+    // if pivotAtStart[i] is set, otherwise at its end
+    QVector<double> knots;
+    QVector<uchar> pivotAtStart;
+
+    void buildCurve()
+    {
+        knots.clear();
+        pivotAtStart.clear();
+
+        knots.append(0.0);
+
+        if (pivotValues.isEmpty()) {
+            // Same as a single power function
+            addSegment(1.0, true);
+
+            return;
+        }
+
+        // Start to first pivot
+        addSegment(pivotValues.first(), false);
+
+        // Between pivots, meeting at the midpoint
+        for (int i = 1; i < pivotValues.size(); i++) {
+            addSegment((pivotValues[i - 1] + pivotValues[i]) * 0.5, true);
+            addSegment(pivotValues[i], false);
+        }
+
+        // Last pivot to end
+        addSegment(1.0, true);
+    }
+
+    void addSegment(double end, bool pivotStart)
+    {
+        // Skip empty segments, e.g. for a pivot at 0 or 1
+        if (end <= knots.last()) {
+            return;
+        }
+
+        knots.append(end);
+        pivotAtStart.append(pivotStart);
+    }
+
+    int segment(double t) const
+    {
+        // Binary search of the interior knots
+        const double* first = knots.constData() + 1;
+        const double* last = knots.constData() + knots.size() - 1;
+
+        return std::upper_bound(first, last, t) - first;
+    }
+
+    double evaluate(int i, double t, bool inverse) const
+    {
+        double t0 = knots[i];
+        double t1 = knots[i + 1];
+        double w = t1 - t0;
+
+        // Flip the flat end instead of using an exponent < 1.0
+        bool invert = exponent < 1.0;
+        double e = invert ? 1.0 / exponent : exponent;
+
+        if (inverse) {
+            e = 1.0 / e;
+        }
+
+        if ((pivotAtStart[i] != 0) != invert) {
+            return t0 + qPow((t - t0) / w, e, accuracy) * w;
+        }
+        else {
+            return t1 - qPow((t1 - t) / w, e, accuracy) * w;
+        }
+    }
+
+    template <class T>
+    void evaluate(const T* in, T* out, int n, bool inverse) const
+    {
+        int last = knots.size() - 2;
+        int s = 0;
+
+        for (int i = 0; i < n; i++) {
+            double t = in[i];
+
+            if (t > knots[s + 1] && s < last && (s + 1 == last || t <= knots[s + 2])) {
+                // Next segment
+                s++;
+            }
+            else if ((t < knots[s] && s > 0) || (t > knots[s + 1] && s < last)) {
+                s = segment(t);
+            }
+
+            out[i] = evaluate(s, t, inverse);
+        }
+    }
+};
+
+
+// Monotone cubic spline through control points, as used by QSplineSlider.
+//
+// The curve always runs from (0, 0) to (1, 1).  Slopes are chosen with the
+// Fritsch-Butland method, so the curve is monotone if the control points are,
+// and the cubic coefficients are stored per interval in sorted arrays.  The
+// inverse starts from a cached table at evenly spaced values and is refined
+// with Newton steps.
+class QSplineMapping
+{
+public:
+    QSplineMapping()
+    {
+        setControlPoints(QVector<QPointF>());
+    }
+
+    QSplineMapping(const QVector<QPointF>& points)
+    {
+        // Straight line if the points are rejected
+        setControlPoints(QVector<QPointF>());
+        setControlPoints(points);
+    }
+
+    // Interior control points, sorted by x
+    const QVector<QPointF>& getControlPoints() const
+    {
+        return controlPoints;
+    }
+
+    // Points are sorted by x, and points outside (0, 1) in x or sharing an x
+    // with an earlier point are dropped.  If y then decreases anywhere the
+    // curve would not be monotone, so the points are rejected, leaving the
+    // current ones, and false is returned.
+    bool setControlPoints(const QVector<QPointF>& points)
+    {
+        QVector<QPointF> sorted;
+
+        for (int i = 0; i < points.size(); i++) {
+            if (points[i].x() > 0.0 && points[i].x() < 1.0) {
+                sorted.append(QPointF(points[i].x(), qBound(0.0, points[i].y(), 1.0)));
+            }
+        }
+
+        std::stable_sort(sorted.begin(), sorted.end(), lessX);
+
+        QVector<QPointF> distinct;
+
+        for (int i = 0; i < sorted.size(); i++) {
+            if (!distinct.isEmpty() && sorted[i].x() == distinct.last().x()) {
+                continue;
+            }
+
+            if (!distinct.isEmpty() && sorted[i].y() < distinct.last().y()) {
+                return false;
+            }
+
+            distinct.append(sorted[i]);
+        }
+
+        controlPoints = distinct;
+
+        buildCurve();
+
+        return true;
+    }
+
+    // Interval boundaries in x, sorted, from 0 to 1
+    const QVector<double>& getKnots() const
+    {
+        return knots;
+    }
+
+    double yFromX(double x) const
+    {
+        return evaluate(segment(x), x);
+    }
+
+    double xFromY(double y) const
+    {
+        y = qBound(0.0, y, 1.0);
+
+        // Initial guess from the table
+        double f = y * (inverseTableSize - 1);
+        int j = qMin((int)f, inverseTableSize - 2);
+
+        // The table entries bracket the answer
+        double a = inverseTable[j];
+        double b = inverseTable[j + 1];
+
+        double x = a + (f - j) * (b - a);
+
+        // Newton steps, bisecting instead if a step leaves the bracket.  Two
+        // steps are usually enough, but more are needed next to flat stretches.
+        for (int k = 0; k < 8; k++) {
+            int i = segment(x);
+            double e = evaluate(i, x) - y;
+            double d = derivative(i, x);
+
+            if (qAbs(e) < 1e-12) {
+                break;
+            }
+
+            if (e < 0.0) {
+                a = x;
+            }
+            else {
+                b = x;
+            }
+
+            double next = d > 0.0 ? x - e / d : a;
+
+            x = next > a && next < b ? next : (a + b) * 0.5;
+        }
+
+        return x;
+    }
+
+    // Map n values at once.  Sorted input steps from one interval to the next
+    // instead of searching for each value.
+    template <class T>
+    void yFromX(const T* x, T* y, int n) const
+    {
+        int last = knots.size() - 2;
+        int s = 0;
+
+        for (int i = 0; i < n; i++) {
+            double t = x[i];
+
+            while (s < last && t >= knots[s + 1] && (s + 1 == last || t < knots[s + 2])) {
+                s++;
+            }
+
+            if ((t < knots[s] && s > 0) || (t >= knots[s + 1] && s < last)) {
+                s = segment(t);
+            }
+
+            y[i] = evaluate(s, t);
+        }
+    }
+
+    template <class T>
+    void xFromY(const T* y, T* x, int n) const
+    {
+        for (int i = 0; i < n; i++) {
+            x[i] = xFromY(y[i]);
+        }
+    }
+
+protected:
+    // Size of the inverse table
+    enum { inverseTableSize = 257 };
+
+    // Interior control points
+    QVector<QPointF> controlPoints;
+
+    // Interval i spans knots[i] to knots[i + 1], where
+    // y = y0[i] + dx * (c1[i] + dx * (c2[i] + dx * c3[i])), with dx = x - knots[i]
+    QVector<double> knots;
+    QVector<double> y0;
+    QVector<double> c1;
+    QVector<double> c2;
+    QVector<double> c3;
+
+    // x at evenly spaced y
+    QVector<double> inverseTable;
+
+    static bool lessX(const QPointF& a, const QPointF& b)
+    {
+        return a.x() < b.x();
+    }
+
+    void buildCurve()
+    {
+        // All points, including the ends, skipping repeated x
+        QVector<double> px;
+        QVector<double> py;
+
+        px.append(0.0);
+        py.append(0.0);
+
+        for (int i = 0; i < controlPoints.size(); i++) {
+            if (controlPoints[i].x() > px.last()) {
+                px.append(controlPoints[i].x());
+                py.append(controlPoints[i].y());
+            }
+        }
+
+        px.append(1.0);
+        py.append(1.0);
+
+        int n = px.size() - 1;
+
+        // Secant slopes
+        QVector<double> h(n);
+        QVector<double> delta(n);
+
+        for (int i = 0; i < n; i++) {
+            h[i] = px[i + 1] - px[i];
+            delta[i] = (py[i + 1] - py[i]) / h[i];
+        }
+
+        // Tangents, using the Fritsch-Butland weighted harmonic mean inside
+        QVector<double> m(n + 1);
+
+        m[0] = delta[0];
+        m[n] = delta[n - 1];
+
+        for (int i = 1; i < n; i++) {
+            if (delta[i - 1] * delta[i] <= 0.0) {
+                m[i] = 0.0;
+            }
+            else {
+                m[i] = 3.0 * (h[i - 1] + h[i]) /
+                       ((2.0 * h[i] + h[i - 1]) / delta[i - 1] + (h[i] + 2.0 * h[i - 1]) / delta[i]);
+            }
+        }
+
+        // Cubic coefficients
+        knots = px;
+        y0 = py;
+        y0.resize(n);
+        c1.resize(n);
+        c2.resize(n);
+        c3.resize(n);
+
+        for (int i = 0; i < n; i++) {
+            c1[i] = m[i];
+            c2[i] = (3.0 * delta[i] - 2.0 * m[i] - m[i + 1]) / h[i];
+            c3[i] = (m[i] + m[i + 1] - 2.0 * delta[i]) / (h[i] * h[i]);
+        }
+
+        // Inverse table, by bisection
+        inverseTable.resize(inverseTableSize);
+
+        for (int j = 0; j < inverseTableSize; j++) {
+            double y = (double)j / (inverseTableSize - 1);
+            double a = 0.0;
+            double b = 1.0;
+
+            for (int k = 0; k < 40; k++) {
+                double c = (a + b) * 0.5;
+
+                if (yFromX(c) < y) {
+                    a = c;
+                }
+                else {
+                    b = c;
+                }
+            }
+
+            inverseTable[j] = (a + b) * 0.5;
+        }
+    }
+
+    int segment(double x) const
+    {
+        // Binary search of the interior knots
+        const double* first = knots.constData() + 1;
+        const double* last = knots.constData() + knots.size() - 1;
+
+        return std::upper_bound(first, last, x) - first;
+    }
+
+    double evaluate(int i, double x) const
+    {
+        double dx = x - knots[i];
+
+        return y0[i] + dx * (c1[i] + dx * (c2[i] + dx * c3[i]));
+    }
+
+    double derivative(int i, double x) const
+    {
+        double dx = x - knots[i];
+
+        return c1[i] + dx * (2.0 * c2[i] + dx * 3.0 * c3[i]);
+    }
+};
+
+
+// Logarithmic mapping spanning a given number of decades
+class QLogMapping
+{
+public:
+    QLogMapping()
+        : decades(3.0)
+    {
+        buildScale();
+    }
+
+    double getDecades() const
+    {
+        return decades;
+    }
+
+    void setDecades(double d)
+    {
+        decades = qMax(d, 1e-6);
+
+        buildScale();
+    }
+
+    double yFromX(double x) const
+    {
+        return (qExp(x * k) - 1.0) / scale;
+    }
+
+    double xFromY(double y) const
+    {
+        return qLn(1.0 + y * scale) / k;
+    }
+
+protected:
+    // Number of decades covered by the slider
+    double decades;
+
+    // Cached constants
+    double k;
+    double scale;
+
+    void buildScale()
+    {
+        k = decades * qLn(10.0);
+        scale = qExp(k) - 1.0;
+    }
+};
+
+
+#endif
\ No newline at end of file
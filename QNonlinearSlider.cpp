@@ -14,7 +14,16 @@
 
 #include "QNonlinearSlider.h"
 
+#include "QDataIndex.h"
+#include "QScientificRepaintScheduler.h"
+#include "QScientificSignalMonitor.h"
+
+#include <QtCore/qmath.h>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QFontMetrics>
 #include <QPainter>
+#include <QPolygonF>
 
 
 QNonlinearSlider::QNonlinearSlider(QWidget* parent)
@@ -37,6 +46,46 @@ QNonlinearSlider::QNonlinearSlider(QWidget* parent)
 
     borderX = handleRadius + 1;
     borderY = valueRadius + 1;
+
+    // No data
+    dataIndex = 0;
+    coverageVisible = false;
+
+    // No snapping
+    snapValues = 0;
+
+    // No hints
+    hintsEnabled = false;
+
+    // Hints may be queued to another thread
+    qRegisterMetaType<QVector<double> >("QVector<double>");
+
+    // Ticks are placed with the curve
+    ticksVisible = true;
+    ticksDirty = true;
+
+    // No updates yet
+    updateSequence = 0;
+    lastPhase = QInteractionFinal;
+    qRegisterMetaType<QInteractionPhase>("QInteractionPhase");
+
+    // Not dragging yet
+    dragging = false;
+    interactiveQuality = ReducedQuality;
+
+    // Compute geometry when first needed
+    handleDirty = true;
+    curveDirty = true;
+    inverseDirty = true;
+
+    // Nothing posted yet.  Register the event type here, from the GUI thread.
+    postedValue = value;
+    postedValuePending = 0;
+    postedValueEventType();
+
+    // Not in a transaction
+    transactionDepth = 0;
+    transactionSignalsBlocked = false;
 }
 
 
@@ -45,24 +94,65 @@ double QNonlinearSlider::getValue() const
     return value;
 }
 
+double QNonlinearSlider::getMinimum() const
+{
+    return minimum;
+}
+
+double QNonlinearSlider::getMaximum() const
+{
+    return maximum;
+}
+
 
 void QNonlinearSlider::setValue(double v) 
+{
+    if (qBound(minimum, v, maximum) == value) {
+        return;
+    }
+
+    setValue(v, dragging ? QInteractionPreview : QInteractionFinal);
+}
+
+void QNonlinearSlider::setValue(double v, QInteractionPhase phase)
 {
     v = qBound(minimum, v, maximum);
 
     if (v == value) {
+        // Pass on the beginning or end of a linked interaction
+        if (phase != QInteractionPreview && phase != lastPhase) {
+            emitValueUpdated(phase);
+        }
+
         return;
     }
 
     value = v;
 
-    setHandleFromValue();
+    invalidateHandle();
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "valueChanged", value);
+
     emit valueChanged(value);
+    emitValueUpdated(phase);
 
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+void QNonlinearSlider::postValue(double v)
+{
+    // Store the newest value
+    postedValueMutex.lock();
+    postedValue = v;
+    postedValueMutex.unlock();
+
+    // Only post an event if one isn't already pending
+    if (postedValuePending.testAndSetOrdered(0, 1)) {
+        QCoreApplication::postEvent(this, new QEvent(postedValueEventType()));
+    }
 }
 
 
@@ -80,15 +170,183 @@ void QNonlinearSlider::setMaximum(double max)
 
 void QNonlinearSlider::setRange(double min, double max)
 {
-    int oldMin = minimum;
-    int oldMax = maximum;
+    double oldMin = minimum;
+    double oldMax = maximum;
 
     minimum = qMin(min, max);
     maximum = qMax(min, max);
 
     if (oldMin != minimum || oldMax != maximum) {
+        invalidateCurve();
+
         // Ensure valid value
         setValue(value);
+
+        // Emit the range as a signal
+        emit rangeChanged(minimum, maximum);
+
+        // Repaint
+        QScientificRepaintScheduler::schedule(this);
+    }
+}
+
+
+void QNonlinearSlider::getLookupTable(float* table, int size) const
+{
+    for (int i = 0; i < size; i++) {
+        double x = size > 1 ? (double)i / (size - 1) : 0.0;
+
+        table[i] = widgetYFromValue(valueFromWidgetX(x));
+    }
+}
+
+
+void QNonlinearSlider::beginTransaction()
+{
+    if (transactionDepth++ > 0) {
+        return;
+    }
+
+    // Save the current state, and hold back signals until the end
+    transactionValue = value;
+    transactionMinimum = minimum;
+    transactionMaximum = maximum;
+
+    transactionSignalsBlocked = blockSignals(true);
+}
+
+void QNonlinearSlider::endTransaction()
+{
+    if (transactionDepth == 0 || --transactionDepth > 0) {
+        return;
+    }
+
+    blockSignals(transactionSignalsBlocked);
+
+    // Emit what changed, once
+    if (value != transactionValue) {
+        QScientificSignalScope scope(this, "valueChanged", value);
+
+        emit valueChanged(value);
+        emitValueUpdated(dragging ? QInteractionPreview : QInteractionFinal);
+    }
+
+    if (minimum != transactionMinimum || maximum != transactionMaximum) {
+        emit rangeChanged(minimum, maximum);
+    }
+}
+
+
+const QDataIndex* QNonlinearSlider::getDataIndex() const
+{
+    return dataIndex;
+}
+
+void QNonlinearSlider::setDataIndex(const QDataIndex* index)
+{
+    dataIndex = index;
+
+    if (coverageVisible) {
+        QScientificRepaintScheduler::schedule(this);
+    }
+}
+
+
+const QDataIndex* QNonlinearSlider::getSnapValues() const
+{
+    return snapValues;
+}
+
+void QNonlinearSlider::setSnapValues(const QDataIndex* values)
+{
+    snapValues = values;
+}
+
+
+bool QNonlinearSlider::getHintsEnabled() const
+{
+    return hintsEnabled;
+}
+
+void QNonlinearSlider::setHintsEnabled(bool enabled)
+{
+    hintsEnabled = enabled;
+}
+
+int QNonlinearSlider::getHintInterval() const
+{
+    return dragPredictor.getInterval();
+}
+
+void QNonlinearSlider::setHintInterval(int ms)
+{
+    dragPredictor.setInterval(ms);
+}
+
+
+qint64 QNonlinearSlider::getCountBelow() const
+{
+    return dataIndex ? dataIndex->countBelow(value) : 0;
+}
+
+qint64 QNonlinearSlider::getCountAbove() const
+{
+    return dataIndex ? dataIndex->countAbove(value) : 0;
+}
+
+
+bool QNonlinearSlider::getCoverageVisible() const
+{
+    return coverageVisible;
+}
+
+void QNonlinearSlider::setCoverageVisible(bool visible)
+{
+    if (visible == coverageVisible) {
+        return;
+    }
+
+    coverageVisible = visible;
+
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+bool QNonlinearSlider::getTicksVisible() const
+{
+    return ticksVisible;
+}
+
+void QNonlinearSlider::setTicksVisible(bool visible)
+{
+    if (visible == ticksVisible) {
+        return;
+    }
+
+    ticksVisible = visible;
+    ticksDirty = true;
+
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QNonlinearSlider::RenderQuality QNonlinearSlider::getInteractiveQuality() const
+{
+    return interactiveQuality;
+}
+
+void QNonlinearSlider::setInteractiveQuality(RenderQuality quality)
+{
+    if (quality == interactiveQuality) {
+        return;
+    }
+
+    interactiveQuality = quality;
+
+    if (dragging) {
+        invalidateCurve();
+
+        QScientificRepaintScheduler::schedule(this);
     }
 }
 
@@ -108,58 +366,333 @@ QSize QNonlinearSlider::minimumSizeHint() const
 }
 
 
+bool QNonlinearSlider::event(QEvent* event)
+{
+    if (event->type() == postedValueEventType()) {
+        // Clear the pending flag before reading, so a value posted after this
+        // read will post a new event
+        postedValuePending.fetchAndStoreOrdered(0);
+
+        postedValueMutex.lock();
+        double v = postedValue;
+        postedValueMutex.unlock();
+
+        setValue(v);
+
+        return true;
+    }
+
+    if (event->type() == QEvent::FontChange || event->type() == QEvent::LocaleChange) {
+        // Labels need laying out again
+        tickLabels.clear();
+        ticksDirty = true;
+    }
+
+    return QWidget::event(event);
+}
+
+
 void QNonlinearSlider::paintEvent(QPaintEvent* event)
 {
     QPainter painter(this);
 
 
     // Positions and sizes may need to change
-//    setHandleFromValue();
+    ensureGeometry();
 
-    
-    // Draw border
-    painter.setRenderHint(QPainter::Antialiasing, false);
 
-    painter.setPen(palette().mid());
-    painter.setBrush(Qt::NoBrush);    
+    // Draw
+    QNonlinearSliderPainter sliderPainter = getSliderPainter();
 
-    painter.drawRect(borderX - 1, borderY - 1, functionWidth() + 1, functionHeight() + 1);
+    sliderPainter.drawBorder(&painter, palette());
+    drawTicks(&painter);
+    sliderPainter.drawCurve(&painter, palette(), curve);
+    sliderPainter.drawValue(&painter, palette(), handle.x(), widgetYFromValue(value));
+    sliderPainter.drawHandle(&painter, palette(), handle.x());
 
+    drawCoverage(&painter);
+}
 
-    // Draw function
-//    painter.setPen(Qt::black);
-    painter.setRenderHint(QPainter::Antialiasing);
 
-    QPointF previous(borderX, functionHeight() + borderY);
-    for (int i = borderX + 1; i <= borderX + functionWidth(); i++) {
-        double x = (double)(i - borderX) / functionWidth();
-        double y = widgetYFromValue(valueFromWidgetX(x));
+void QNonlinearSlider::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
 
-        QPointF p = pixelsFromWidget(QPointF(x, y));
+    // Curve is sampled per pixel
+    invalidateCurve();
+}
 
-        painter.drawLine(previous, p);
 
-        previous = p;
+void QNonlinearSlider::setDragging(bool drag)
+{
+    if (drag == dragging) {
+        return;
     }
-    
 
-    // Draw value
-    QColor color = palette().window().color();
-    painter.setBrush(color);
+    // The curve is sampled more coarsely in draft quality
+    bool resample = curveSampleStep() != 1 || (drag && interactiveQuality == DraftQuality);
 
-    painter.drawEllipse(pixelsFromWidget(QPointF(handle.x(), widgetYFromValue(value))), valueRadius, valueRadius);
-    
+    dragging = drag;
+
+    // Velocity is per drag
+    dragPredictor.reset();
+
+    if (resample) {
+        invalidateCurve();
+    }
+
+    // Move the handle onto the snapped value
+    bool snap = !drag && snapValues;
+
+    if (snap) {
+        invalidateHandle();
+    }
+
+    // Redraw at the new quality
+    if (interactiveQuality != FullQuality || snap) {
+        QScientificRepaintScheduler::schedule(this);
+    }
 
-    // Draw handle
-    color.setAlphaF(0.5);
-    painter.setBrush(color);
-    painter.setPen(Qt::black);
+    emitValueUpdated(drag ? QInteractionBegin : QInteractionFinal);
+}
+
+void QNonlinearSlider::emitValueUpdated(QInteractionPhase phase)
+{
+    lastPhase = phase;
+
+    emit valueUpdated(value, phase, ++updateSequence);
+}
+
+QNonlinearSlider::RenderQuality QNonlinearSlider::renderQuality() const
+{
+    return dragging ? interactiveQuality : FullQuality;
+}
+
+int QNonlinearSlider::curveSampleStep() const
+{
+    return renderQuality() == DraftQuality ? 4 : 1;
+}
+
+
+void QNonlinearSlider::invalidateHandle()
+{
+    handleDirty = true;
+}
+
+void QNonlinearSlider::invalidateCurve()
+{
+    curveDirty = true;
+    inverseDirty = true;
+    ticksDirty = true;
+    handleDirty = true;
+}
+
+void QNonlinearSlider::ensureGeometry()
+{
+    if (curveDirty) {
+        sampleCurve(curve);
+
+        curveDirty = false;
+    }
+
+    if (ticksDirty) {
+        updateTicks();
+
+        ticksDirty = false;
+    }
+
+    if (handleDirty) {
+        setHandleFromValue();
+
+        handleDirty = false;
+    }
+}
+
+
+QEvent::Type QNonlinearSlider::postedValueEventType()
+{
+    static QEvent::Type type = (QEvent::Type)QEvent::registerEventType();
+
+    return type;
+}
+
+
+void QNonlinearSlider::drawCoverage(QPainter* painter) const
+{
+    if (!coverageVisible || !dataIndex || dataIndex->isEmpty()) {
+        return;
+    }
+
+    double n = dataIndex->size();
+
+    QString below = QString("%1%").arg(100.0 * getCountBelow() / n, 0, 'f', 1);
+    QString above = QString("%1%").arg(100.0 * getCountAbove() / n, 0, 'f', 1);
+
+    painter->setFont(labelFont());
+    painter->setPen(palette().text().color());
+
+    QRect r = rect().adjusted(borderX + 1, borderY, -borderX - 1, -borderY);
+
+    painter->drawText(r, Qt::AlignTop | Qt::AlignLeft, below);
+    painter->drawText(r, Qt::AlignTop | Qt::AlignRight, above);
+}
+
+
+void QNonlinearSlider::updateTicks()
+{
+    ticks.clear();
+
+    int w = functionWidth();
+
+    if (!ticksVisible || w <= 0 || maximum <= minimum) {
+        return;
+    }
+
+    QFont font = labelFont();
+    QFontMetrics metrics(font);
+
+    // Tick marks are this long, and labels this far apart, in pixels
+    int tickLength = 3;
+    int gap = metrics.width(' ') * 2;
+
+    double bottom = height() - borderY;
+
+    // A round step giving about four intervals
+    double range = maximum - minimum;
+    double magnitude = qPow(10.0, qFloor(log10(range / 4.0)));
+    double fraction = range / 4.0 / magnitude;
+    double coarseStep = (fraction < 1.5 ? 1.0 : fraction < 3.0 ? 2.0 : fraction < 7.0 ? 5.0 : 10.0) * magnitude;
+
+    // Try the coarse values first, then finer ones where they fit, so the
+    // curve decides where labels are dense
+    static const int divisors[] = { 1, 2, 5, 10, 20, 50, 100 };
+
+    QVector<double> placedValues;
+    QVector<QPair<double, double> > placedSpans;
+
+    // Beyond 2^53 steps from zero, step counts are no longer exact doubles
+    const double maxSteps = 9007199254740992.0;
+
+    for (unsigned int d = 0; d < sizeof(divisors) / sizeof(divisors[0]); d++) {
+        double step = coarseStep / divisors[d];
+
+        // Steps too fine for the range, or a range that isn't finite, can't
+        // be counted, and finer steps would be no better
+        if (!(qAbs(minimum / step) < maxSteps && qAbs(maximum / step) < maxSteps)) {
+            break;
+        }
+
+        for (qint64 k = (qint64)ceil(minimum / step - 1e-6); k * step <= maximum + step * 1e-6; k++) {
+            double v = k * step;
+
+            if (k == 0) {
+                // Avoid -0
+                v = 0.0;
+            }
+
+            // Already placed at a coarser step
+            bool placed = false;
+
+            for (int i = 0; i < placedValues.size() && !placed; i++) {
+                placed = qAbs(placedValues[i] - v) < step * 1e-6;
+            }
+
+            if (placed) {
+                continue;
+            }
+
+            // Format and measure each label once
+            QMap<double, TickLabel>::iterator it = tickLabels.find(v);
+
+            if (it == tickLabels.end()) {
+                TickLabel label;
+                label.text.setText(locale().toString(v, 'g', 6));
+                label.width = metrics.width(label.text.text());
+                label.prepared = false;
+
+                it = tickLabels.insert(v, label);
+            }
+
+            double x = borderX + widgetXFromValue(v) * w;
+            double labelWidth = it.value().width;
+            double left = qBound((double)borderX, x - labelWidth / 2.0, (double)(width() - borderX) - labelWidth);
+
+            // Skip labels that would overlap others
+            bool overlaps = false;
+
+            for (int i = 0; i < placedSpans.size() && !overlaps; i++) {
+                overlaps = left < placedSpans[i].second + gap && placedSpans[i].first < left + labelWidth + gap;
+            }
+
+            if (overlaps) {
+                continue;
+            }
+
+            placedValues.append(v);
+            placedSpans.append(qMakePair(left, left + labelWidth));
+
+            // Lay out each shown label once
+            if (!it.value().prepared) {
+                it.value().text.setPerformanceHint(QStaticText::AggressiveCaching);
+                it.value().text.prepare(QTransform(), font);
+                it.value().prepared = true;
+            }
+
+            Tick tick;
+            tick.x = x;
+            tick.labelPosition = QPointF(left, bottom - tickLength - metrics.height());
+            tick.label = it.value().text;
+
+            ticks.append(tick);
+        }
+    }
 
-    painter.drawEllipse(pixelsFromWidget(handle), handleRadius, handleRadius);
+    // Labels for values no longer in range accumulate as the range changes
+    if (tickLabels.size() > 4096) {
+        tickLabels.clear();
+    }
+}
+
+void QNonlinearSlider::drawTicks(QPainter* painter) const
+{
+    if (!ticksVisible || ticks.isEmpty()) {
+        return;
+    }
+
+    painter->save();
+
+    painter->setFont(labelFont());
+    painter->setPen(palette().color(QPalette::Disabled, QPalette::Text));
+
+    double bottom = height() - borderY;
+
+    for (int i = 0; i < ticks.size(); i++) {
+        painter->drawLine(QPointF(ticks[i].x, bottom), QPointF(ticks[i].x, bottom - 3));
+        painter->drawStaticText(ticks[i].labelPosition, ticks[i].label);
+    }
+
+    painter->restore();
+}
+
+
+QFont QNonlinearSlider::labelFont() const
+{
+    QFont labelFont = font();
 
+    if (labelFont.pointSizeF() > 0.0) {
+        labelFont.setPointSizeF(labelFont.pointSizeF() * 0.75);
+    }
 
-    // Draw text
-//    painter.drawText(rect(), Qt::AlignTop, locale().toString(value, 'e', 4));
+    return labelFont;
+}
+
+
+QNonlinearSliderPainter QNonlinearSlider::getSliderPainter() const
+{
+    QNonlinearSliderPainter sliderPainter(rect(), handleRadius, valueRadius, borderX, borderY);
+    sliderPainter.setAntialiasing(renderQuality() == FullQuality);
+
+    return sliderPainter;
 }
 
 
@@ -173,6 +706,13 @@ void QNonlinearSlider::setValueFromHandle()
 {
     double v = valueFromWidgetX(handle.x());
 
+    if (snapValues) {
+        v = snapValues->nearest(v, minimum, maximum);
+    }
+
+    // Hint even if the value hasn't changed, as the handle may still be moving
+    updateHint(v);
+
     if (v == value) {
         return;
     }
@@ -180,10 +720,74 @@ void QNonlinearSlider::setValueFromHandle()
     value = v;    
 
     // Emit the value as a signal
+    QScientificSignalScope scope(this, "valueChanged", value);
+
     emit valueChanged(value);
+    emitValueUpdated(QInteractionPreview);
+}
+
+void QNonlinearSlider::updateHint(double current)
+{
+    dragPredictor.addPosition(handle);
+
+    if (!hintsEnabled || !dragPredictor.hintDue()) {
+        return;
+    }
+
+    // Values at the next few hint intervals, without repeats
+    QVector<double> values;
+    double last = current;
+
+    for (int i = 1; i <= 3; i++) {
+        double v = valueFromWidgetX(dragPredictor.predictPosition(i * dragPredictor.getInterval()).x());
+
+        if (snapValues) {
+            v = snapValues->nearest(v, minimum, maximum);
+        }
+
+        if (v != last && v != current) {
+            values.append(v);
+        }
+
+        last = v;
+    }
+
+    if (!values.isEmpty()) {
+        emit valueHint(values);
+    }
 }
 
 
+double QNonlinearSlider::widgetXFromValue(double v) const
+{
+    if (inverseDirty) {
+        buildInverseTable();
+    }
+
+    double y = qBound(0.0, widgetYFromValue(v), 1.0);
+
+    // Table entries bracket the position
+    double f = y * inverseTableSize;
+    int j = qMin((int)f, inverseTableSize - 1);
+
+    double a = inverseTable[j];
+    double b = qMin(inverseTable[j + 1] + 1.0 / inverseSampleCount, 1.0);
+
+    // Bisect to well below a pixel
+    while (b - a > 1e-6) {
+        double c = (a + b) * 0.5;
+
+        if (widgetYFromValue(valueFromWidgetX(c)) < y) {
+            a = c;
+        }
+        else {
+            b = c;
+        }
+    }
+
+    return (a + b) * 0.5;
+}
+
 double QNonlinearSlider::widgetYFromValue(double v) const
 {
     return (v - minimum) / (maximum - minimum);
@@ -199,6 +803,60 @@ QPointF QNonlinearSlider::pixelsFromWidget(QPointF p) const
     return QPointF(borderX + p.x() * functionWidth(), height() - borderY - p.y() * functionHeight());
 }
 
+void QNonlinearSlider::buildInverseTable() const
+{
+    // Sample the forward function, forcing it to be monotone
+    QVector<double> samples(inverseSampleCount + 1);
+
+    double y = -1.0;
+
+    for (int i = 0; i <= inverseSampleCount; i++) {
+        y = qMax(y, widgetYFromValue(valueFromWidgetX((double)i / inverseSampleCount)));
+        samples[i] = y;
+    }
+
+    // Find the last sample below each table value by walking the samples
+    inverseTable.resize(inverseTableSize + 1);
+
+    int i = 0;
+
+    for (int j = 0; j <= inverseTableSize; j++) {
+        double target = (double)j / inverseTableSize;
+
+        while (i < inverseSampleCount && samples[i + 1] < target) {
+            i++;
+        }
+
+        inverseTable[j] = (double)i / inverseSampleCount;
+    }
+
+    inverseDirty = false;
+}
+
+
+void QNonlinearSlider::sampleCurve(QPolygonF& curve) const
+{
+    int w = functionWidth();
+
+    if (w <= 0) {
+        curve.clear();
+
+        return;
+    }
+
+    int step = curveSampleStep();
+    int n = (w + step - 1) / step;
+
+    curve.resize(n + 1);
+
+    for (int i = 0; i <= n; i++) {
+        double x = (double)qMin(i * step, w) / w;
+        double y = widgetYFromValue(valueFromWidgetX(x));
+
+        curve[i] = pixelsFromWidget(QPointF(x, y));
+    }
+}
+
 
 int QNonlinearSlider::functionWidth() const
 {
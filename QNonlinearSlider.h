@@ -17,6 +17,19 @@
 
 
 #include <QWidget>
+#include <QAtomicInt>
+#include <QMap>
+#include <QMutex>
+#include <QPolygonF>
+#include <QStaticText>
+#include <QVector>
+
+#include "QDragPredictor.h"
+#include "QInteractionPhase.h"
+#include "QNonlinearSliderPainter.h"
+#include "QScientificMetaTypes.h"
+
+class QDataIndex;
 
 
 class QNonlinearSlider : public QWidget
@@ -26,22 +39,102 @@ class QNonlinearSlider : public QWidget
 public:
     QNonlinearSlider(QWidget* parent = 0);
 
+    // Rendering quality
+    enum RenderQuality {
+        FullQuality,        // Antialiased, with all decorations
+        ReducedQuality,     // No antialiasing or decorations
+        DraftQuality        // As ReducedQuality, with a coarsely sampled curve
+    };
+
     double getValue() const;
+    double getMinimum() const;
+    double getMaximum() const;
 
     void setMinimum(double min);
     void setMaximum(double max);
     void setRange(double min, double max);
 
+    // Thread-safe alternative to setValue() for feeding values from worker threads.
+    // Only the newest value is kept, and at most one event is pending at a time,
+    // so the GUI thread applies just the latest value however fast values arrive.
+    void postValue(double v);
+
+    // Fills the table with normalized values at evenly spaced slider positions
+    virtual void getLookupTable(float* table, int size) const;
+
+    // Group several setter calls, so each changed signal is emitted once, with
+    // the final value, by the outermost endTransaction().  Calls may be nested.
+    virtual void beginTransaction();
+    virtual void endTransaction();
+
+    // Data to count samples below and above the value in, not owned
+    const QDataIndex* getDataIndex() const;
+    void setDataIndex(const QDataIndex* index);
+
+    // Numbers of samples below and above the value, or 0 without data
+    qint64 getCountBelow() const;
+    qint64 getCountAbove() const;
+
+    // Whether to draw the fractions below and above the value
+    bool getCoverageVisible() const;
+    void setCoverageVisible(bool visible);
+
+    // Whether to draw value ticks and labels along the bottom, on by default.
+    // Ticks are at round values, as many as fit, so they are denser where the
+    // curve spreads values out.
+    bool getTicksVisible() const;
+    void setTicksVisible(bool visible);
+
+    // Values to snap to when dragging, e.g. from QDataIndex::setDistinctData(),
+    // not owned.  Values only change when the nearest one does, so dragging
+    // between them emits nothing.  Null to drag freely.
+    const QDataIndex* getSnapValues() const;
+    void setSnapValues(const QDataIndex* values);
+
+    // Whether to emit valueHint() while dragging, off by default, and the
+    // minimum time between hints in milliseconds
+    bool getHintsEnabled() const;
+    void setHintsEnabled(bool enabled);
+    int getHintInterval() const;
+    void setHintInterval(int ms);
+
+    // Quality used while the user is dragging, ReducedQuality by default.
+    // Full quality is always used otherwise.
+    RenderQuality getInteractiveQuality() const;
+    void setInteractiveQuality(RenderQuality quality);
+
     virtual QSize sizeHint() const;
     virtual QSize minimumSizeHint() const;
 
 public slots:
     void setValue(double v);
 
+    // As setValue(), but the update carries the given phase, so connecting
+    // another widget's valueUpdated() here passes its drag phases on instead
+    // of tagging every value Final.  An unchanged value is only passed on to
+    // begin or end an interaction, and only once, which also stops cycles of
+    // links.
+    void setValue(double v, QInteractionPhase phase);
+
 signals:
     void valueChanged(double v);
+    void rangeChanged(double min, double max);
+
+    // Emitted by subclasses when the shape of the curve changes, e.g. its
+    // exponent or pivots, so anything derived from getLookupTable() is stale
+    void curveChanged();
+
+    // Every value update, with its interaction phase and sequence number.
+    // Unlike valueChanged(), also emitted when a drag begins and ends.
+    void valueUpdated(double v, QInteractionPhase phase, qint64 sequence);
+
     void sliderReleased();
 
+    // Values the handle is predicted to reach over the next few hint intervals
+    // at its current drag velocity, e.g. for prefetching.  Only a hint: the
+    // value has not changed.
+    void valueHint(const QVector<double>& values);
+
 protected:
     // Value
     double value;
@@ -65,13 +158,121 @@ protected:
     QPoint oldMousePosition;
     QPointF oldHandlePosition;
 
+    // Data for coverage counts, and whether to draw them
+    const QDataIndex* dataIndex;
+    bool coverageVisible;
+
+    // Values to snap to, if any
+    const QDataIndex* snapValues;
+
+    // Axis ticks, in pixels, and their labels.  Tick positions are
+    // recomputed when the curve changes, and labels are kept by value with
+    // their width until the font changes, and only laid out once shown.
+    struct Tick {
+        double x;
+        QPointF labelPosition;
+        QStaticText label;
+    };
+
+    struct TickLabel {
+        QStaticText text;
+        double width;
+        bool prepared;
+    };
+
+    bool ticksVisible;
+    bool ticksDirty;
+    QVector<Tick> ticks;
+    QMap<double, TickLabel> tickLabels;
+
+    // Sequence number of the last valueUpdated()
+    qint64 updateSequence;
+
+    // Drag velocity for value hints
+    QDragPredictor dragPredictor;
+    bool hintsEnabled;
+
+    // Whether the user is dragging, and the quality to draw with while they are
+    bool dragging;
+    RenderQuality interactiveQuality;
+
+    // Newest value from postValue(), and whether an event to apply it is pending
+    QMutex postedValueMutex;
+    double postedValue;
+    QAtomicInt postedValuePending;
+
+    // Transaction state, and the values before the outermost beginTransaction()
+    int transactionDepth;
+    bool transactionSignalsBlocked;
+    double transactionValue;
+    double transactionMinimum;
+    double transactionMaximum;
+
+    // Cached function samples, in pixel coordinates
+    QPolygonF curve;
+
+    // Whether the handle or curve need to be recomputed.  Setters just mark
+    // these, and they are recomputed by ensureGeometry() before painting or
+    // interaction, so hidden or scrolled-out widgets do no extra work.
+    bool handleDirty;
+    bool curveDirty;
+
+    // For the default widgetXFromValue(), the last of inverseSampleCount + 1
+    // evenly spaced slider positions below each of inverseTableSize + 1 evenly
+    // spaced normalized values.  Built when first needed after invalidateCurve().
+    enum { inverseTableSize = 256, inverseSampleCount = 1024 };
+    mutable QVector<double> inverseTable;
+    mutable bool inverseDirty;
+
     // Internal methods    
+    virtual bool event(QEvent* event);
     virtual void paintEvent(QPaintEvent* event);
+    virtual void resizeEvent(QResizeEvent* event);
+
+    // Switches between full and interactive quality, and begins or ends the
+    // interaction
+    void setDragging(bool drag);
+
+    void emitValueUpdated(QInteractionPhase phase);
+
+    // Phase of the last valueUpdated()
+    QInteractionPhase lastPhase;
+
+    // Quality to draw with now, and the curve sampling step in pixels for it
+    RenderQuality renderQuality() const;
+    int curveSampleStep() const;
+
+    void invalidateHandle();
+    void invalidateCurve();
+    void ensureGeometry();
+
+    static QEvent::Type postedValueEventType();
+
+    // Draws the fractions of samples below and above the value, if enabled
+    void drawCoverage(QPainter* painter) const;
+
+    // Places the ticks for the current curve and size, and draws them
+    void updateTicks();
+    void drawTicks(QPainter* painter) const;
+
+    // Font for coverage and tick labels
+    QFont labelFont() const;
+
+    // Returns a painter for drawing in the widget rectangle with this appearance and quality
+    QNonlinearSliderPainter getSliderPainter() const;
 
     virtual void setHandleFromValue();
     virtual void setValueFromHandle();
 
-    virtual double widgetXFromValue(double v) const = 0;
+    // Tracks the dragged handle, and emits valueHint() when due, given the
+    // value for the handle's current position
+    void updateHint(double current);
+
+    // The default inverts valueFromWidgetX() with a cached table, so subclasses
+    // only need the forward function.  It must be non-decreasing, and subclasses
+    // must call invalidateCurve() when it changes.  Override if an exact inverse
+    // is available.
+    virtual double widgetXFromValue(double v) const;
     virtual double widgetYFromValue(double v) const;
 
     virtual double valueFromWidgetX(double x) const = 0;
@@ -79,6 +280,11 @@ protected:
 
     virtual QPointF pixelsFromWidget(QPointF p) const;
 
+    void buildInverseTable() const;
+
+    // Samples the function at each pixel column, in pixel coordinates
+    virtual void sampleCurve(QPolygonF& curve) const;
+
     // Returns the width and height in pixels used for the function
     virtual int functionWidth() const;
     virtual int functionHeight() const;
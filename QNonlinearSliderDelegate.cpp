@@ -0,0 +1,393 @@
+/*=========================================================================
+
+  Name:        QNonlinearSliderDelegate.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: An item delegate that draws and edits power or exploratory
+               sliders directly from model data, so views with many rows
+               do not need a slider widget per cell.
+
+=========================================================================*/
+
+
+#include "QNonlinearSliderDelegate.h"
+
+#include "QNonlinearMapping.h"
+#include "QNonlinearSliderPainter.h"
+
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOption>
+
+
+QNonlinearSliderDelegate::QNonlinearSliderDelegate(MappingType type, QObject* parent)
+    : QStyledItemDelegate(parent), mappingType(type)
+{
+    // Set defaults
+    minimum = 0.0;
+    maximum = 1.0;
+    exponent = 1.0;
+    pivotValue = 0.5;
+
+    accuracy = QPowExact;
+
+    // Appearance
+    handleRadius = 7;
+
+    // No interaction to start with
+    action = QNonlinearSliderDelegateNoAction;
+    dragModel = 0;
+    dragViewport = 0;
+    oldHandleX = 0.0;
+}
+
+
+void QNonlinearSliderDelegate::setRange(double min, double max)
+{
+    minimum = qMin(min, max);
+    maximum = qMax(min, max);
+}
+
+void QNonlinearSliderDelegate::setExponent(double e)
+{
+    exponent = e;
+}
+
+void QNonlinearSliderDelegate::setPivotValue(double pv)
+{
+    pivotValue = pv;
+}
+
+void QNonlinearSliderDelegate::setAccuracy(QPowAccuracy accuracy)
+{
+    this->accuracy = accuracy;
+}
+
+
+void QNonlinearSliderDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    // Draw the item background and selection, but no text
+    QStyleOptionViewItemV4 opt = option;
+    initStyleOption(&opt, index);
+    opt.text = QString();
+
+    const QWidget* widget = opt.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+
+    // Sample the curve
+    Parameters p = getParameters(index);
+
+    QNonlinearSliderPainter sliderPainter = getSliderPainter(option.rect);
+
+    QPolygonF curve;
+
+    if (mappingType == ExploratoryMapping) {
+        sliderPainter.sampleCurve(QExploratoryMapping(p.exponent, p.pivotValue, accuracy), curve);
+    }
+    else {
+        sliderPainter.sampleCurve(QPowerMapping(p.exponent, accuracy), curve);
+    }
+
+    // Handle position, which is the source of truth while dragging
+    double handleX = action == QNonlinearSliderDelegateMoveHandle && index == dragIndex ?
+                     oldHandleX : widgetXFromValue(p);
+
+    double valueY = (p.value - p.minimum) / (p.maximum - p.minimum);
+
+
+    // Draw
+    painter->save();
+
+    if (mappingType == ExploratoryMapping) {
+        sliderPainter.drawBackground(painter, option.palette);
+    }
+
+    sliderPainter.drawBorder(painter, option.palette);
+    sliderPainter.drawCurve(painter, option.palette, curve);
+
+    if (mappingType == ExploratoryMapping) {
+        sliderPainter.drawPivot(painter, option.palette, QExploratoryMapping(p.exponent, p.pivotValue, accuracy).xFromY(p.pivotValue), p.pivotValue);
+    }
+
+    sliderPainter.drawValue(painter, option.palette, handleX, valueY);
+    sliderPainter.drawHandle(painter, option.palette, handleX);
+
+    painter->restore();
+}
+
+
+QSize QNonlinearSliderDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    int h = handleRadius * 4;
+
+    return QSize(h * 3, h);
+}
+
+
+QWidget* QNonlinearSliderDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    return 0;
+}
+
+
+bool QNonlinearSliderDelegate::editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index)
+{
+    if (event->type() == QEvent::MouseButtonPress) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+
+        // Only care about left-button presses
+        if (mouseEvent->button() != Qt::LeftButton) {
+            return false;
+        }
+
+        // Need the viewport to follow the drag, since views do not pass mouse moves to delegates
+        const QStyleOptionViewItemV3* v3 = qstyleoption_cast<const QStyleOptionViewItemV3*>(&option);
+        const QAbstractItemView* view = v3 ? qobject_cast<const QAbstractItemView*>(v3->widget) : 0;
+
+        if (!view) {
+            return false;
+        }
+
+        // Intersect with the handle
+        Parameters p = getParameters(index);
+
+        double handleX = widgetXFromValue(p);
+
+        bool onHandle = getSliderPainter(option.rect).handleContains(handleX, mouseEvent->pos());
+
+        if (onHandle) {
+            action = QNonlinearSliderDelegateMoveHandle;
+
+            oldHandleX = handleX;
+        }
+        else {
+            // Wait for vertical movement before changing the exponent
+            action = QNonlinearSliderDelegatePressed;
+        }
+
+        // Save drag state
+        dragIndex = index;
+        dragModel = model;
+        pressPosition = mouseEvent->pos();
+        oldMousePosition = mouseEvent->pos();
+
+        dragViewport = view->viewport();
+        dragViewport->installEventFilter(this);
+
+        // Let the view select the item on clicks off the handle
+        return onHandle;
+    }
+    else if (event->type() == QEvent::MouseButtonDblClick) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+
+        if (mappingType != ExploratoryMapping) {
+            return false;
+        }
+
+        Parameters p = getParameters(index);
+
+        switch (mouseEvent->button()) {
+
+            case Qt::LeftButton:
+                // Set the pivot value
+                model->setData(index, (p.value - p.minimum) / (p.maximum - p.minimum), PivotValueRole);
+
+                return true;
+
+            case Qt::RightButton:
+                // Reset exponent and pivot
+                model->setData(index, 1.0, ExponentRole);
+                model->setData(index, 0.5, PivotValueRole);
+
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+
+bool QNonlinearSliderDelegate::eventFilter(QObject* object, QEvent* event)
+{
+    if (object != dragViewport || action == QNonlinearSliderDelegateNoAction) {
+        return QStyledItemDelegate::eventFilter(object, event);
+    }
+
+    switch (event->type()) {
+
+        case QEvent::MouseMove: {
+            QPoint pos = static_cast<QMouseEvent*>(event)->pos();
+
+            if (action == QNonlinearSliderDelegatePressed) {
+                if (qAbs(pos.y() - pressPosition.y()) < QApplication::startDragDistance()) {
+                    return false;
+                }
+
+                action = QNonlinearSliderDelegateChangeExponent;
+            }
+
+            dragTo(pos);
+
+            return true;
+        }
+
+        case QEvent::MouseButtonRelease: {
+            // The view saw the press unless the handle was grabbed
+            bool handled = action == QNonlinearSliderDelegateMoveHandle;
+
+            endDrag();
+
+            return handled;
+        }
+
+        default:
+            return QStyledItemDelegate::eventFilter(object, event);
+    }
+}
+
+
+void QNonlinearSliderDelegate::dragTo(const QPoint& pos)
+{
+    // The item may have been removed, or the view closed, while dragging
+    QRect rect = getDragRect();
+
+    if (rect.isNull()) {
+        endDrag();
+
+        return;
+    }
+
+    // Get the delta between the last event and here
+    QPoint delta = pos - oldMousePosition;
+    delta.setY(-delta.y());
+
+    // Save the mouse position
+    oldMousePosition = pos;
+
+    Parameters p = getParameters(dragIndex);
+
+    switch (action) {
+
+        case QNonlinearSliderDelegateMoveHandle:
+            // Move handle
+            oldHandleX = qBound(0.0, oldHandleX + (double)delta.x() / rect.width(), 1.0);
+
+            // Update value
+            dragModel->setData(dragIndex, valueFromWidgetX(p, oldHandleX), Qt::EditRole);
+
+            break;
+
+        case QNonlinearSliderDelegateChangeExponent:
+            if (delta.y() < 0) {
+                // Increase exponent
+                dragModel->setData(dragIndex, p.exponent * 1.1, ExponentRole);
+            }
+            else if (delta.y() > 0) {
+                // Decrease exponent
+                dragModel->setData(dragIndex, p.exponent / 1.1, ExponentRole);
+            }
+
+            break;
+
+        default:
+            break;
+    }
+
+    // Repaint the item
+    dragViewport->update(rect);
+}
+
+void QNonlinearSliderDelegate::endDrag()
+{
+    if (dragViewport) {
+        dragViewport->removeEventFilter(this);
+        dragViewport->update(getDragRect());
+    }
+
+    action = QNonlinearSliderDelegateNoAction;
+    dragIndex = QPersistentModelIndex();
+    dragModel = 0;
+    dragViewport = 0;
+}
+
+QRect QNonlinearSliderDelegate::getDragRect() const
+{
+    QAbstractItemView* view = dragViewport ? qobject_cast<QAbstractItemView*>(dragViewport->parentWidget()) : 0;
+
+    if (!view || !dragIndex.isValid()) {
+        return QRect();
+    }
+
+    // The view may have scrolled or resized the item since the press
+    return view->visualRect(dragIndex);
+}
+
+
+QNonlinearSliderDelegate::Parameters QNonlinearSliderDelegate::getParameters(const QModelIndex& index) const
+{
+    Parameters p;
+
+    QVariant v;
+
+    p.value = index.data(Qt::EditRole).toDouble();
+
+    v = index.data(MinimumRole);
+    p.minimum = v.isValid() ? v.toDouble() : minimum;
+
+    v = index.data(MaximumRole);
+    p.maximum = v.isValid() ? v.toDouble() : maximum;
+
+    v = index.data(ExponentRole);
+    p.exponent = v.isValid() ? v.toDouble() : exponent;
+
+    v = index.data(PivotValueRole);
+    p.pivotValue = v.isValid() ? v.toDouble() : pivotValue;
+
+    p.value = qBound(p.minimum, p.value, p.maximum);
+
+    return p;
+}
+
+
+double QNonlinearSliderDelegate::widgetXFromValue(const Parameters& p) const
+{
+    double y = (p.value - p.minimum) / (p.maximum - p.minimum);
+
+    if (mappingType == ExploratoryMapping) {
+        return QExploratoryMapping(p.exponent, p.pivotValue, accuracy).xFromY(y);
+    }
+    else {
+        return QPowerMapping(p.exponent, accuracy).xFromY(y);
+    }
+}
+
+double QNonlinearSliderDelegate::valueFromWidgetX(const Parameters& p, double x) const
+{
+    double y;
+
+    if (mappingType == ExploratoryMapping) {
+        y = QExploratoryMapping(p.exponent, p.pivotValue, accuracy).yFromX(x);
+    }
+    else {
+        y = QPowerMapping(p.exponent, accuracy).yFromX(x);
+    }
+
+    return p.minimum + y * (p.maximum - p.minimum);
+}
+
+
+QNonlinearSliderPainter QNonlinearSliderDelegate::getSliderPainter(const QRect& rect) const
+{
+    return QNonlinearSliderPainter(rect, handleRadius);
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+/*=========================================================================
+
+  Name:        QNonlinearSliderDelegate.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: An item delegate that draws and edits power or exploratory
+               sliders directly from model data, so views with many rows
+               do not need a slider widget per cell.
+
+               The value is read from and written to Qt::EditRole.  The
+               range, exponent and pivot value are read from the roles
+               below if the model provides them, otherwise the delegate
+               defaults are used.  Dragging vertically off the handle
+               changes the exponent, and double-clicking sets or resets the
+               pivot, as with the widgets, if the model stores those roles.
+               Clicks off the handle are left to the view for selection.
+
+=========================================================================*/
+
+
+#ifndef QNONLINEARSLIDERDELEGATE_H
+#define QNONLINEARSLIDERDELEGATE_H
+
+
+#include <QStyledItemDelegate>
+#include <QPersistentModelIndex>
+#include <QPointer>
+
+#include "QFastMath.h"
+
+class QNonlinearSliderPainter;
+
+
+class QNonlinearSliderDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    // Mapping used for the sliders
+    enum MappingType {
+        PowerMapping,
+        ExploratoryMapping
+    };
+
+    // Model roles for per-item slider parameters
+    enum ItemDataRole {
+        MinimumRole = Qt::UserRole + 100,
+        MaximumRole,
+        ExponentRole,
+        PivotValueRole
+    };
+
+    QNonlinearSliderDelegate(MappingType type = PowerMapping, QObject* parent = 0);
+
+    // Defaults used when the model does not provide a role
+    void setRange(double min, double max);
+    void setExponent(double e);
+    void setPivotValue(double pv);
+
+    void setAccuracy(QPowAccuracy accuracy);
+
+    virtual void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+    virtual QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const;
+
+    // No editor widgets are created; editing is done in editorEvent()
+    virtual QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+
+protected:
+    // Slider parameters for one item
+    struct Parameters {
+        double value;
+        double minimum;
+        double maximum;
+        double exponent;
+        double pivotValue;
+    };
+
+    MappingType mappingType;
+
+    // Defaults
+    double minimum;
+    double maximum;
+    double exponent;
+    double pivotValue;
+
+    QPowAccuracy accuracy;
+
+    // Size of drawn elements, in pixels
+    int handleRadius;
+
+    // Interaction states
+    enum QNonlinearSliderDelegateAction {
+        QNonlinearSliderDelegateNoAction,
+        QNonlinearSliderDelegateMoveHandle,
+        QNonlinearSliderDelegatePressed,
+        QNonlinearSliderDelegateChangeExponent
+    };
+    QNonlinearSliderDelegateAction action;
+
+    // Drag state, only for the item being dragged
+    QPersistentModelIndex dragIndex;
+    QAbstractItemModel* dragModel;
+    QPointer<QWidget> dragViewport;
+    QPoint pressPosition;
+    QPoint oldMousePosition;
+    double oldHandleX;
+
+    // Internal methods
+    virtual bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option, const QModelIndex& index);
+    virtual bool eventFilter(QObject* object, QEvent* event);
+
+    void dragTo(const QPoint& p);
+    void endDrag();
+
+    // Current rectangle of the item being dragged, or null if it is gone
+    QRect getDragRect() const;
+
+    Parameters getParameters(const QModelIndex& index) const;
+
+    double widgetXFromValue(const Parameters& p) const;
+    double valueFromWidgetX(const Parameters& p, double x) const;
+
+    QNonlinearSliderPainter getSliderPainter(const QRect& rect) const;
+};
+
+
+#endif
\ No newline at end of file
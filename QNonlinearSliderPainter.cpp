@@ -0,0 +1,148 @@
+/*=========================================================================
+
+  Name:        QNonlinearSliderPainter.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Geometry and drawing for nonlinear sliders in an arbitrary
+               rectangle, without needing a widget.  Used by the slider
+               widgets themselves, by QMultiSliderPanel for each row, and
+               by QNonlinearSliderDelegate for item view cells.
+
+=========================================================================*/
+
+
+#include "QNonlinearSliderPainter.h"
+
+#include <QtCore/qmath.h>
+#include <QPainter>
+#include <QPalette>
+
+
+QNonlinearSliderPainter::QNonlinearSliderPainter(const QRect& rect, int handleRadius)
+    : rect(rect), handleRadius(handleRadius)
+{
+    valueRadius = handleRadius / 2;
+    pivotRadius = 1.5;
+
+    antialiasing = true;
+
+    borderX = handleRadius + 1;
+    borderY = valueRadius + 1;
+}
+
+QNonlinearSliderPainter::QNonlinearSliderPainter(const QRect& rect, int handleRadius, int valueRadius, int borderX, int borderY)
+    : rect(rect), handleRadius(handleRadius), valueRadius(valueRadius), borderX(borderX), borderY(borderY)
+{
+    pivotRadius = 1.5;
+
+    antialiasing = true;
+}
+
+
+void QNonlinearSliderPainter::setPivotRadius(double radius)
+{
+    pivotRadius = radius;
+}
+
+void QNonlinearSliderPainter::setAntialiasing(bool antialiasing)
+{
+    this->antialiasing = antialiasing;
+}
+
+
+int QNonlinearSliderPainter::functionWidth() const
+{
+    return rect.width() - borderX * 2;
+}
+
+int QNonlinearSliderPainter::functionHeight() const
+{
+    return rect.height() - borderY * 2;
+}
+
+
+QPointF QNonlinearSliderPainter::pixelsFromWidget(const QPointF& p) const
+{
+    return QPointF(rect.left() + borderX + p.x() * functionWidth(),
+                   rect.top() + rect.height() - borderY - p.y() * functionHeight());
+}
+
+double QNonlinearSliderPainter::widgetXFromPixels(double x) const
+{
+    return qBound(0.0, (x - rect.left() - borderX) / functionWidth(), 1.0);
+}
+
+
+bool QNonlinearSliderPainter::handleContains(double handleX, const QPoint& p) const
+{
+    QPointF d = p - pixelsFromWidget(QPointF(handleX, 0.5));
+
+    return qSqrt(d.x() * d.x() + d.y() * d.y()) <= handleRadius;
+}
+
+
+void QNonlinearSliderPainter::drawBackground(QPainter* painter, const QPalette& palette) const
+{
+    // Draw background cross
+    painter->setRenderHint(QPainter::Antialiasing, false);
+
+    painter->setPen(palette.midlight().color());
+
+    painter->drawLine(pixelsFromWidget(QPointF(0.5, 0.0)), pixelsFromWidget(QPointF(0.5, 1.0)));
+    painter->drawLine(pixelsFromWidget(QPointF(0.0, 0.5)), pixelsFromWidget(QPointF(1.0, 0.5)));
+}
+
+void QNonlinearSliderPainter::drawBorder(QPainter* painter, const QPalette& palette) const
+{
+    painter->setRenderHint(QPainter::Antialiasing, false);
+
+    painter->setPen(palette.mid().color());
+    painter->setBrush(Qt::NoBrush);
+
+    painter->drawRect(rect.left() + borderX - 1, rect.top() + borderY - 1, functionWidth() + 1, functionHeight() + 1);
+}
+
+void QNonlinearSliderPainter::drawCurve(QPainter* painter, const QPalette& palette, const QPolygonF& curve) const
+{
+    painter->setRenderHint(QPainter::Antialiasing, antialiasing);
+
+    painter->setPen(palette.mid().color());
+
+    painter->drawPolyline(curve);
+}
+
+void QNonlinearSliderPainter::drawPivot(QPainter* painter, const QPalette& palette, double pivotX, double pivotValue) const
+{
+    painter->setRenderHint(QPainter::Antialiasing, antialiasing);
+
+    painter->setPen(palette.mid().color());
+    painter->setBrush(palette.mid());
+
+    painter->drawEllipse(pixelsFromWidget(QPointF(pivotX, pivotValue)), pivotRadius, pivotRadius);
+}
+
+void QNonlinearSliderPainter::drawValue(QPainter* painter, const QPalette& palette, double handleX, double valueY) const
+{
+    painter->setRenderHint(QPainter::Antialiasing, antialiasing);
+
+    painter->setPen(palette.mid().color());
+    painter->setBrush(palette.window().color());
+
+    painter->drawEllipse(pixelsFromWidget(QPointF(handleX, valueY)), valueRadius, valueRadius);
+}
+
+void QNonlinearSliderPainter::drawHandle(QPainter* painter, const QPalette& palette, double handleX) const
+{
+    painter->setRenderHint(QPainter::Antialiasing, antialiasing);
+
+    QColor color = palette.window().color();
+    color.setAlphaF(0.5);
+
+    painter->setBrush(color);
+    painter->setPen(Qt::black);
+
+    painter->drawEllipse(pixelsFromWidget(QPointF(handleX, 0.5)), handleRadius, handleRadius);
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+/*=========================================================================
+
+  Name:        QNonlinearSliderPainter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Geometry and drawing for nonlinear sliders in an arbitrary
+               rectangle, without needing a widget.  Used by the slider
+               widgets themselves, by QMultiSliderPanel for each row, and
+               by QNonlinearSliderDelegate for item view cells.
+
+=========================================================================*/
+
+
+#ifndef QNONLINEARSLIDERPAINTER_H
+#define QNONLINEARSLIDERPAINTER_H
+
+
+#include <QPoint>
+#include <QPolygonF>
+#include <QRect>
+
+class QPainter;
+class QPalette;
+
+
+class QNonlinearSliderPainter
+{
+public:
+    // Use the default appearance of the slider widgets for the given handle radius
+    QNonlinearSliderPainter(const QRect& rect, int handleRadius = 7);
+
+    QNonlinearSliderPainter(const QRect& rect, int handleRadius, int valueRadius, int borderX, int borderY);
+
+    void setPivotRadius(double radius);
+
+    // Antialiasing is on by default, and can be turned off for faster drawing
+    void setAntialiasing(bool antialiasing);
+
+    // Returns the width and height in pixels used for the function
+    int functionWidth() const;
+    int functionHeight() const;
+
+    // Map between normalized and pixel coordinates
+    QPointF pixelsFromWidget(const QPointF& p) const;
+    double widgetXFromPixels(double x) const;
+
+    // Returns true if the point, in pixels, is on the handle
+    bool handleContains(double handleX, const QPoint& p) const;
+
+    // Samples the mapping at every step pixel columns, and at the last
+    // column, in pixel coordinates.  The curve is empty if the rectangle
+    // is too narrow to draw in.
+    template <class Mapping>
+    void sampleCurve(const Mapping& mapping, QPolygonF& curve, int step = 1) const
+    {
+        int w = functionWidth();
+        int h = functionHeight();
+
+        if (w <= 0) {
+            curve.clear();
+
+            return;
+        }
+
+        double x0 = rect.left() + borderX;
+        double y0 = rect.top() + rect.height() - borderY;
+
+        step = qMax(step, 1);
+        int n = (w + step - 1) / step;
+
+        curve.resize(n + 1);
+        QPointF* p = curve.data();
+
+        for (int i = 0; i <= n; i++) {
+            double x = (double)qMin(i * step, w) / w;
+
+            p[i] = QPointF(x0 + x * w, y0 - mapping.yFromX(x) * h);
+        }
+    }
+
+    // Drawing, in back to front order
+    void drawBackground(QPainter* painter, const QPalette& palette) const;
+    void drawBorder(QPainter* painter, const QPalette& palette) const;
+    void drawCurve(QPainter* painter, const QPalette& palette, const QPolygonF& curve) const;
+    void drawPivot(QPainter* painter, const QPalette& palette, double pivotX, double pivotValue) const;
+    void drawValue(QPainter* painter, const QPalette& palette, double handleX, double valueY) const;
+    void drawHandle(QPainter* painter, const QPalette& palette, double handleX) const;
+
+protected:
+    // Rectangle to draw in
+    QRect rect;
+
+    // Size of drawn elements, in pixels
+    int handleRadius;
+    int valueRadius;
+    double pivotRadius;
+
+    bool antialiasing;
+
+    // Border from edge of rectangle
+    int borderX;
+    int borderY;
+};
+
+
+#endif
\ No newline at end of file
@@ -14,16 +14,15 @@
 
 #include "QPowerSlider.h"
 
+#include "QScientificRepaintScheduler.h"
+
 #include <QtCore/qmath.h>
 #include <QMouseEvent>
 
 
 QPowerSlider::QPowerSlider(QWidget* parent)
-    : QNonlinearSlider(parent)
+    : QMappedSlider<QPowerMapping>(parent)
 {
-    // Default to linear function
-    exponent = 1.0;
-
     // No interaction to start with
     action = QPowerSliderNoAction;
 }
@@ -31,26 +30,79 @@ QPowerSlider::QPowerSlider(QWidget* parent)
 
 double QPowerSlider::getExponent()
 {
-    return exponent;
+    return mapping.getExponent();
 }
 
 
 void QPowerSlider::setExponent(double e)
 {
-    if (e == exponent) {
+    if (e == mapping.getExponent()) {
         return;
     }
 
-    exponent = e;
+    mapping.setExponent(e);
 
-    // Update the handle
-    setHandleFromValue();
+    // Curve and handle need updating
+    invalidateCurve();
 
     // Emit the exponent as a signal
-    emit exponentChanged(exponent);
+    emit exponentChanged(mapping.getExponent());
+    emit curveChanged();
 
     // Repaint
-    update();
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QPowAccuracy QPowerSlider::getAccuracy() const
+{
+    return mapping.getAccuracy();
+}
+
+
+void QPowerSlider::setAccuracy(QPowAccuracy accuracy)
+{
+    if (accuracy == mapping.getAccuracy()) {
+        return;
+    }
+
+    mapping.setAccuracy(accuracy);
+
+    // Curve and handle need updating
+    invalidateCurve();
+
+    emit curveChanged();
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+QCurveCoefficients QPowerSlider::getCoefficients() const
+{
+    return QCurveCoefficients(mapping, minimum, maximum);
+}
+
+
+void QPowerSlider::beginTransaction()
+{
+    if (transactionDepth == 0) {
+        transactionExponent = mapping.getExponent();
+    }
+
+    QNonlinearSlider::beginTransaction();
+}
+
+void QPowerSlider::endTransaction()
+{
+    bool outermost = transactionDepth == 1;
+
+    QNonlinearSlider::endTransaction();
+
+    if (outermost && mapping.getExponent() != transactionExponent) {
+        emit exponentChanged(mapping.getExponent());
+        emit curveChanged();
+    }
 }
 
 
@@ -72,6 +124,9 @@ void QPowerSlider::mousePressEvent(QMouseEvent* event)
     p.setX(qBound(0, p.x(), width()));
     p.setY(qBound(0, p.y(), height()));
 
+    // Make sure the handle is up to date
+    ensureGeometry();
+
     // Intersect with control
     action = QPowerSliderNoAction;
 
@@ -86,6 +141,8 @@ void QPowerSlider::mousePressEvent(QMouseEvent* event)
         action = QPowerSliderChangeExponent;
     }
 
+    setDragging(true);
+
     // Save mouse position
     oldMousePosition = p;
 }
@@ -108,6 +165,9 @@ void QPowerSlider::mouseReleaseEvent(QMouseEvent* event)
 
     // Clear action variable
     action = QPowerSliderNoAction;
+
+    // Back to full quality
+    setDragging(false);
 }
 
 
@@ -143,11 +203,11 @@ void QPowerSlider::mouseMoveEvent(QMouseEvent* event)
         case QPowerSliderChangeExponent:         
             if (delta.y() < 0) {
                 // Increase exponent
-                setExponent(exponent * 1.1);
+                setExponent(mapping.getExponent() * 1.1);
             }
             else {
                 // Decrease exponent
-                setExponent(exponent / 1.1);
+                setExponent(mapping.getExponent() / 1.1);
             }
 
             break;
@@ -157,35 +217,5 @@ void QPowerSlider::mouseMoveEvent(QMouseEvent* event)
     oldHandlePosition = handle;
     
     // Repaint
-    update();
-}
-
-
-double QPowerSlider::widgetXFromValue(double v) const
-{
-    double y = widgetYFromValue(v);
-
-    if (exponent < 1.0) {
-        // Instead of using an exponent < 1.0, flip the curve to flatten out curve horizontally near 1.0
-        return 1.0 - qPow(1.0 - y, exponent);   
-    }
-    else {
-        double e = 1.0 / exponent;
-
-        return qPow(y, e);
-    }
-}
-
-
-double QPowerSlider::valueFromWidgetX(double x) const
-{
-    if (exponent < 1.0) {
-        // Instead of using an exponent < 1.0, flip the curve to flatten out curve horizontally near 1.0
-        double e = 1.0 / exponent;
-
-        return minimum + (1.0 - qPow((1.0 - x), e)) * (maximum - minimum);
-    }
-    else {
-        return minimum + qPow(x, exponent) * (maximum - minimum);
-    }
+    QScientificRepaintScheduler::schedule(this);
 }
\ No newline at end of file
@@ -16,10 +16,11 @@
 #define QPOWERSLIDER_H
 
 
-#include "QNonlinearSlider.h"
+#include "QCurveCoefficients.h"
+#include "QMappedSlider.h"
 
 
-class QPowerSlider : public QNonlinearSlider
+class QPowerSlider : public QMappedSlider<QPowerMapping>
 {
     Q_OBJECT
 
@@ -28,6 +29,16 @@ public:
 
     double getExponent();
 
+    // Accuracy used for evaluating the power function
+    QPowAccuracy getAccuracy() const;
+    void setAccuracy(QPowAccuracy accuracy);
+
+    // The current curve and range, for evaluating in a shader
+    QCurveCoefficients getCoefficients() const;
+
+    virtual void beginTransaction();
+    virtual void endTransaction();
+
 public slots:
     void setExponent(double e);
 
@@ -35,9 +46,6 @@ signals:
     void exponentChanged(double e);
 
 protected:
-    // Exponent for power function
-    double exponent;
-
     // Interaction states
     enum QPowerSliderAction {
         QPowerSliderNoAction,
@@ -46,13 +54,13 @@ protected:
     };
     QPowerSliderAction action;
 
+    // Exponent before the outermost beginTransaction()
+    double transactionExponent;
+
     // Internal methods
     void mousePressEvent(QMouseEvent* event);
     void mouseReleaseEvent(QMouseEvent* event);
     void mouseMoveEvent(QMouseEvent* event);
-
-    double widgetXFromValue(double v) const;
-    double valueFromWidgetX(double x) const;
 };
 
 
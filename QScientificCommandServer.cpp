@@ -0,0 +1,346 @@
+/*=========================================================================
+
+  Name:        QScientificCommandServer.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A local socket server that lets another process, e.g. a
+               regression script, set widget parameters in batches.
+
+=========================================================================*/
+
+
+#include "QScientificCommandServer.h"
+
+#include "QDualValue.h"
+#include "QExploratorySlider.h"
+#include "QNonlinearSlider.h"
+#include "QPowerSlider.h"
+
+#include <QDataStream>
+#include <QList>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QVector>
+
+
+QScientificCommandServer::QScientificCommandServer(QObject* parent)
+    : QObject(parent)
+{
+    server = new QLocalServer(this);
+
+    connect(server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+QScientificCommandServer::~QScientificCommandServer()
+{
+    close();
+}
+
+
+void QScientificCommandServer::addWidget(QNonlinearSlider* slider)
+{
+    addWidget(static_cast<QWidget*>(slider));
+}
+
+void QScientificCommandServer::addWidget(QDualValue* dualValue)
+{
+    addWidget(static_cast<QWidget*>(dualValue));
+}
+
+void QScientificCommandServer::addWidget(QWidget* widget)
+{
+    widgets.insert(widget->objectName(), widget);
+}
+
+
+bool QScientificCommandServer::listen(const QString& name)
+{
+    if (server->listen(name)) {
+        return true;
+    }
+
+    if (server->serverError() != QAbstractSocket::AddressInUseError) {
+        return false;
+    }
+
+    // Only remove the socket if it was left by a crashed process, not if
+    // another instance is still listening on it
+    QLocalSocket probe;
+    probe.connectToServer(name);
+
+    if (probe.waitForConnected(1000)) {
+        probe.abort();
+
+        return false;
+    }
+
+    QLocalServer::removeServer(name);
+
+    return server->listen(name);
+}
+
+void QScientificCommandServer::close()
+{
+    server->close();
+
+    QList<QLocalSocket*> sockets = buffers.keys();
+
+    for (int i = 0; i < sockets.size(); i++) {
+        sockets[i]->disconnect(this);
+        sockets[i]->abort();
+        sockets[i]->deleteLater();
+    }
+
+    buffers.clear();
+}
+
+bool QScientificCommandServer::isListening() const
+{
+    return server->isListening();
+}
+
+
+void QScientificCommandServer::newConnection()
+{
+    while (QLocalSocket* socket = server->nextPendingConnection()) {
+        buffers.insert(socket, QByteArray());
+
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readBatches()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
+    }
+}
+
+void QScientificCommandServer::readBatches()
+{
+    QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+
+    if (!socket || !buffers.contains(socket)) {
+        return;
+    }
+
+    QByteArray buffer = buffers.value(socket) + socket->readAll();
+
+    // Apply each complete batch
+    int offset = 0;
+
+    while (buffer.size() - offset >= 4) {
+        const uchar* p = reinterpret_cast<const uchar*>(buffer.constData() + offset);
+        quint32 size = (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+
+        if (size > MaximumBatchSize) {
+            // Not talking the same protocol
+            buffers.remove(socket);
+            socket->abort();
+
+            return;
+        }
+
+        if ((quint32)(buffer.size() - offset - 4) < size) {
+            break;
+        }
+
+        applyBatch(socket, QByteArray::fromRawData(buffer.constData() + offset + 4, size));
+
+        // The socket may have been closed while applying
+        if (!buffers.contains(socket)) {
+            return;
+        }
+
+        offset += 4 + size;
+    }
+
+    buffers[socket] = buffer.mid(offset);
+}
+
+void QScientificCommandServer::socketDisconnected()
+{
+    QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+
+    if (!socket) {
+        return;
+    }
+
+    buffers.remove(socket);
+    socket->deleteLater();
+}
+
+
+void QScientificCommandServer::applyBatch(QLocalSocket* socket, const QByteArray& batch)
+{
+    QDataStream in(batch);
+    in.setVersion(QDataStream::Qt_4_0);
+
+    quint32 batchId;
+    quint32 count;
+    in >> batchId >> count;
+
+    // Parse everything first, so a malformed batch changes nothing
+    QVector<BatchItem> items;
+    QList<QPointer<QWidget> > touched;
+
+    int failed = 0;
+
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QByteArray name;
+        quint8 command;
+        double arg1;
+        double arg2;
+
+        in >> name >> command >> arg1 >> arg2;
+
+        if (in.status() != QDataStream::Ok) {
+            break;
+        }
+
+        QWidget* widget = widgets.value(QString::fromUtf8(name.constData(), name.size()));
+
+        if (!widget) {
+            failed++;
+
+            continue;
+        }
+
+        if (!touched.contains(widget)) {
+            touched.append(widget);
+        }
+
+        BatchItem item = { widget, command, arg1, arg2 };
+        items.append(item);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        buffers.remove(socket);
+        socket->abort();
+
+        return;
+    }
+
+    // Apply as one transaction per widget
+    for (int i = 0; i < touched.size(); i++) {
+        beginTransaction(touched[i]);
+    }
+
+    int applied = 0;
+
+    for (int i = 0; i < items.size(); i++) {
+        if (applyCommand(items[i].widget, items[i].command, items[i].arg1, items[i].arg2)) {
+            applied++;
+        }
+        else {
+            failed++;
+        }
+    }
+
+    // Slots connected to one widget may delete another
+    for (int i = 0; i < touched.size(); i++) {
+        if (touched[i]) {
+            endTransaction(touched[i]);
+        }
+    }
+
+    // Acknowledge
+    QByteArray reply;
+    QDataStream out(&reply, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_0);
+
+    out << (quint32)12 << batchId << (quint32)applied << (quint32)failed;
+
+    socket->write(reply);
+
+    emit batchApplied(batchId, applied, failed);
+}
+
+bool QScientificCommandServer::applyCommand(QWidget* widget, int command, double arg1, double arg2)
+{
+    if (QNonlinearSlider* slider = qobject_cast<QNonlinearSlider*>(widget)) {
+        QPowerSlider* power = qobject_cast<QPowerSlider*>(slider);
+        QExploratorySlider* exploratory = qobject_cast<QExploratorySlider*>(slider);
+
+        switch (command) {
+
+            case SetValue:
+                slider->setValue(arg1);
+
+                return true;
+
+            case SetRange:
+                slider->setRange(arg1, arg2);
+
+                return true;
+
+            case SetExponent:
+                if (power) {
+                    power->setExponent(arg1);
+
+                    return true;
+                }
+                else if (exploratory) {
+                    exploratory->setExponent(arg1);
+
+                    return true;
+                }
+
+                return false;
+
+            case SetPivotValue:
+                if (exploratory) {
+                    exploratory->setPivotValue(arg1);
+
+                    return true;
+                }
+
+                return false;
+
+            default:
+                return false;
+        }
+    }
+    else if (QDualValue* dualValue = qobject_cast<QDualValue*>(widget)) {
+        switch (command) {
+
+            case SetValues:
+                dualValue->setValues(arg1, arg2);
+
+                return true;
+
+            case SetValue1Range:
+                dualValue->setValue1Range(arg1, arg2);
+
+                return true;
+
+            case SetValue2Range:
+                dualValue->setValue2Range(arg1, arg2);
+
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+
+void QScientificCommandServer::beginTransaction(QWidget* widget)
+{
+    if (QNonlinearSlider* slider = qobject_cast<QNonlinearSlider*>(widget)) {
+        slider->beginTransaction();
+    }
+    else if (QDualValue* dualValue = qobject_cast<QDualValue*>(widget)) {
+        dualValue->beginTransaction();
+    }
+}
+
+void QScientificCommandServer::endTransaction(QWidget* widget)
+{
+    if (QNonlinearSlider* slider = qobject_cast<QNonlinearSlider*>(widget)) {
+        slider->endTransaction();
+    }
+    else if (QDualValue* dualValue = qobject_cast<QDualValue*>(widget)) {
+        dualValue->endTransaction();
+    }
+}
\ No newline at end of file
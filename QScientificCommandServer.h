@@ -0,0 +1,127 @@
+/*=========================================================================
+
+  Name:        QScientificCommandServer.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A local socket server that lets another process, e.g. a
+               regression script, set widget parameters in batches.
+
+               Each batch is applied as one transaction per widget, so
+               every widget repaints once and emits each changed signal
+               once with its final value, and is then acknowledged.
+
+               All integers and doubles are big endian, as written by
+               QDataStream.  A batch is
+
+                   quint32 size           bytes following this field
+                   quint32 batchId
+                   quint32 commandCount
+                   commandCount times:
+                       quint32 nameLength
+                       char    name[nameLength]   UTF-8 object name
+                       quint8  command            a Command value
+                       double  arg1
+                       double  arg2               unused for one-argument
+                                                  commands
+
+               Commands are applied in order.  The acknowledgement is
+
+                   quint32 size           always 12
+                   quint32 batchId
+                   quint32 applied
+                   quint32 failed         unknown widgets or commands
+                                          the widget does not support
+
+=========================================================================*/
+
+
+#ifndef QSCIENTIFICCOMMANDSERVER_H
+#define QSCIENTIFICCOMMANDSERVER_H
+
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QPointer>
+#include <QString>
+
+class QDualValue;
+class QLocalServer;
+class QLocalSocket;
+class QNonlinearSlider;
+class QWidget;
+
+
+class QScientificCommandServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    QScientificCommandServer(QObject* parent = 0);
+    virtual ~QScientificCommandServer();
+
+    // Batch commands
+    enum Command {
+        SetValue = 1,           // Slider value
+        SetRange,               // Slider minimum and maximum
+        SetExponent,            // Power or exploratory slider exponent
+        SetPivotValue,          // Exploratory slider pivot value
+        SetValues,              // QDualValue values 1 and 2
+        SetValue1Range,         // QDualValue value 1 minimum and maximum
+        SetValue2Range          // QDualValue value 2 minimum and maximum
+    };
+
+    // Widgets are addressed by their object name
+    void addWidget(QNonlinearSlider* slider);
+    void addWidget(QDualValue* dualValue);
+
+    // Listen on the given local socket name.  Fails if another process is
+    // already listening on it, but replaces a socket left by a crash.
+    bool listen(const QString& name);
+    void close();
+
+    bool isListening() const;
+
+signals:
+    void batchApplied(quint32 batchId, int applied, int failed);
+
+protected slots:
+    void newConnection();
+    void readBatches();
+    void socketDisconnected();
+
+protected:
+    // Largest batch accepted, in bytes
+    static const quint32 MaximumBatchSize = 64 * 1024 * 1024;
+
+    QLocalServer* server;
+
+    // Widgets by object name
+    QHash<QString, QPointer<QWidget> > widgets;
+
+    // A parsed command
+    struct BatchItem {
+        QWidget* widget;
+        int command;
+        double arg1;
+        double arg2;
+    };
+
+    // Partially received batches for each connection
+    QHash<QLocalSocket*, QByteArray> buffers;
+
+    // Internal methods
+    void addWidget(QWidget* widget);
+
+    void applyBatch(QLocalSocket* socket, const QByteArray& batch);
+    bool applyCommand(QWidget* widget, int command, double arg1, double arg2);
+
+    void beginTransaction(QWidget* widget);
+    void endTransaction(QWidget* widget);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,30 @@
+/*=========================================================================
+
+  Name:        QScientificMetaTypes.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Metatypes for the value lists carried by the widgets'
+               signals, e.g. value hints, pivot values and control points,
+               so the signals can be queued to another thread.  Widgets
+               register them with qRegisterMetaType() when constructed.
+
+=========================================================================*/
+
+
+#ifndef QSCIENTIFICMETATYPES_H
+#define QSCIENTIFICMETATYPES_H
+
+
+#include <QMetaType>
+#include <QPointF>
+#include <QVector>
+
+
+Q_DECLARE_METATYPE(QVector<double>)
+Q_DECLARE_METATYPE(QVector<QPointF>)
+
+
+#endif
\ No newline at end of file
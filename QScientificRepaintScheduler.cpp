@@ -0,0 +1,185 @@
+/*=========================================================================
+
+  Name:        QScientificRepaintScheduler.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Collects repaint requests from the QScientific widgets and
+               flushes them together once per display refresh interval.
+
+=========================================================================*/
+
+
+#include "QScientificRepaintScheduler.h"
+
+#include <QApplication>
+#include <QCursor>
+#include <QWidget>
+
+
+QScientificRepaintScheduler::QScientificRepaintScheduler(QObject* parent)
+    : QObject(parent)
+{
+    frameInterval = 16;
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(flush()));
+
+    clock.start();
+    nextTick = 0;
+    lastFlush = -frameInterval;
+
+    deferred = false;
+
+    frameCount = 0;
+    lateFrameCount = 0;
+    droppedFrameCount = 0;
+}
+
+
+QScientificRepaintScheduler* QScientificRepaintScheduler::instance()
+{
+    // Owned by the application, so it goes away with it
+    static QScientificRepaintScheduler* scheduler = new QScientificRepaintScheduler(qApp);
+
+    return scheduler;
+}
+
+void QScientificRepaintScheduler::schedule(QWidget* widget, const QRect& rect)
+{
+    instance()->add(widget, rect);
+}
+
+
+int QScientificRepaintScheduler::getFrameInterval() const
+{
+    return frameInterval;
+}
+
+void QScientificRepaintScheduler::setFrameInterval(int ms)
+{
+    frameInterval = qMax(ms, 1);
+}
+
+
+int QScientificRepaintScheduler::getFrameCount() const
+{
+    return frameCount;
+}
+
+int QScientificRepaintScheduler::getLateFrameCount() const
+{
+    return lateFrameCount;
+}
+
+int QScientificRepaintScheduler::getDroppedFrameCount() const
+{
+    return droppedFrameCount;
+}
+
+
+void QScientificRepaintScheduler::flush()
+{
+    frameCount++;
+
+    // Check for a late tick
+    lastFlush = clock.elapsed();
+
+    qint64 lateness = lastFlush - nextTick;
+
+    bool late = lateness > frameInterval;
+
+    if (late) {
+        int dropped = lateness / frameInterval;
+
+        lateFrameCount++;
+        droppedFrameCount += dropped;
+
+        emit frameLate(lateness, dropped);
+    }
+
+    // Widgets to flush on this tick
+    QHash<QWidget*, QRegion> flushing;
+
+    if (late && !deferred) {
+        // Flush the widget under the cursor first, and the rest on the next tick
+        QWidget* hovered = QApplication::widgetAt(QCursor::pos());
+
+        if (hovered) {
+            QHash<QWidget*, QRegion>::iterator it = dirty.begin();
+
+            while (it != dirty.end()) {
+                if (it.key() == hovered || it.key()->isAncestorOf(hovered)) {
+                    flushing.insert(it.key(), it.value());
+                    it = dirty.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    if (flushing.isEmpty()) {
+        flushing = dirty;
+        dirty.clear();
+    }
+
+    // Never hold widgets back twice in a row
+    deferred = !dirty.isEmpty();
+
+    // Widgets repainted from the same event loop pass are composited together
+    for (QHash<QWidget*, QRegion>::const_iterator it = flushing.constBegin(); it != flushing.constEnd(); ++it) {
+        it.key()->update(it.value());
+    }
+
+    if (!dirty.isEmpty()) {
+        armTimer();
+    }
+}
+
+void QScientificRepaintScheduler::widgetDestroyed(QObject* object)
+{
+    dirty.remove(static_cast<QWidget*>(object));
+}
+
+
+void QScientificRepaintScheduler::add(QWidget* widget, const QRect& rect)
+{
+    QHash<QWidget*, QRegion>::iterator it = dirty.find(widget);
+
+    if (it == dirty.end()) {
+        connect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(widgetDestroyed(QObject*)), Qt::UniqueConnection);
+
+        it = dirty.insert(widget, QRegion());
+    }
+
+    it.value() += rect.isNull() ? widget->rect() : rect;
+
+    armTimer();
+}
+
+void QScientificRepaintScheduler::armTimer()
+{
+    if (timer.isActive()) {
+        return;
+    }
+
+    qint64 now = clock.elapsed();
+
+    if (now - lastFlush >= frameInterval) {
+        // Idle for a frame, so flush once the current event loop pass is done
+        nextTick = now;
+
+        timer.start(0);
+
+        return;
+    }
+
+    // Align ticks to a fixed grid, so flushes stay periodic
+    nextTick = (now / frameInterval + 1) * frameInterval;
+
+    timer.start(nextTick - now);
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+/*=========================================================================
+
+  Name:        QScientificRepaintScheduler.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Collects repaint requests from the QScientific widgets and
+               flushes them together once per display refresh interval, so
+               a change that ripples through several linked widgets is
+               drawn in one frame instead of several partial ones.
+
+               A request arriving when nothing has been flushed for a frame
+               is flushed at the end of the current event loop pass, with
+               everything else requested in that pass, so only requests
+               made within a frame of the last flush wait for the next
+               tick.
+
+               When a tick arrives late, only the widget under the cursor
+               is flushed on that tick, and the rest on the next one, so
+               the widget being interacted with stays responsive.  Late
+               ticks are reported through frameLate().
+
+=========================================================================*/
+
+
+#ifndef QSCIENTIFICREPAINTSCHEDULER_H
+#define QSCIENTIFICREPAINTSCHEDULER_H
+
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QRect>
+#include <QRegion>
+#include <QTimer>
+
+class QWidget;
+
+
+class QScientificRepaintScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The scheduler shared by all widgets
+    static QScientificRepaintScheduler* instance();
+
+    // Repaints the rectangle, or the whole widget if it is null, on the next tick
+    static void schedule(QWidget* widget, const QRect& rect = QRect());
+
+    // Interval between ticks, in milliseconds.  The default of 16 suits a
+    // 60 Hz display.
+    int getFrameInterval() const;
+    void setFrameInterval(int ms);
+
+    // Statistics since the scheduler was created
+    int getFrameCount() const;
+    int getLateFrameCount() const;
+    int getDroppedFrameCount() const;
+
+signals:
+    // Emitted when a tick arrives more than a frame late, with how late it
+    // was in milliseconds and how many frame intervals were missed
+    void frameLate(int lateness, int droppedFrames);
+
+protected slots:
+    void flush();
+    void widgetDestroyed(QObject* object);
+
+protected:
+    QScientificRepaintScheduler(QObject* parent = 0);
+
+    // Dirty regions waiting for the next tick
+    QHash<QWidget*, QRegion> dirty;
+
+    // Tick timing
+    int frameInterval;
+    QTimer timer;
+    QElapsedTimer clock;
+    qint64 nextTick;
+    qint64 lastFlush;
+
+    // Whether widgets were held back on the last tick
+    bool deferred;
+
+    // Statistics
+    int frameCount;
+    int lateFrameCount;
+    int droppedFrameCount;
+
+    // Internal methods
+    void add(QWidget* widget, const QRect& rect);
+    void armTimer();
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+/*=========================================================================
+
+  Name:        QScientificSignalMonitor.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Watches value signals emitted by the QScientific widgets for
+               feedback loops and signal storms.
+
+=========================================================================*/
+
+
+#include "QScientificSignalMonitor.h"
+
+#include <QCoreApplication>
+
+
+#ifdef QT_NO_DEBUG
+bool QScientificSignalMonitor::enabled = false;
+#else
+bool QScientificSignalMonitor::enabled = true;
+#endif
+
+
+QScientificSignalMonitor::QScientificSignalMonitor(QObject* parent)
+    : QObject(parent)
+{
+    emissions = 0;
+    reported = false;
+
+    maximumDepth = 16;
+    maximumRepeats = 2;
+    maximumEmissions = 256;
+
+    loopCount = 0;
+
+    clock.start();
+}
+
+
+QScientificSignalMonitor* QScientificSignalMonitor::instance()
+{
+    // Owned by the application, so it goes away with it
+    static QScientificSignalMonitor* monitor = new QScientificSignalMonitor(qApp);
+
+    return monitor;
+}
+
+
+bool QScientificSignalMonitor::isEnabled()
+{
+    return enabled;
+}
+
+void QScientificSignalMonitor::setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+
+int QScientificSignalMonitor::getMaximumDepth() const
+{
+    return maximumDepth;
+}
+
+void QScientificSignalMonitor::setMaximumDepth(int depth)
+{
+    maximumDepth = qMax(depth, 1);
+}
+
+int QScientificSignalMonitor::getMaximumRepeats() const
+{
+    return maximumRepeats;
+}
+
+void QScientificSignalMonitor::setMaximumRepeats(int repeats)
+{
+    maximumRepeats = qMax(repeats, 1);
+}
+
+int QScientificSignalMonitor::getMaximumEmissions() const
+{
+    return maximumEmissions;
+}
+
+void QScientificSignalMonitor::setMaximumEmissions(int count)
+{
+    maximumEmissions = qMax(count, 1);
+}
+
+
+int QScientificSignalMonitor::getLoopCount() const
+{
+    return loopCount;
+}
+
+
+void QScientificSignalMonitor::enter(QObject* sender, const char* signal, double value)
+{
+    Link link;
+    link.sender = sender;
+    link.signal = signal;
+    link.pair = false;
+    link.value1 = value;
+    link.value2 = 0.0;
+
+    enter(link);
+}
+
+void QScientificSignalMonitor::enter(QObject* sender, const char* signal, double value1, double value2)
+{
+    Link link;
+    link.sender = sender;
+    link.signal = signal;
+    link.pair = true;
+    link.value1 = value1;
+    link.value2 = value2;
+
+    enter(link);
+}
+
+void QScientificSignalMonitor::enter(const Link& link)
+{
+    // Earlier emissions of the same signal in this chain
+    int repeats = 0;
+    bool changed = false;
+
+    for (int i = 0; i < chain.size(); i++) {
+        if (chain[i].sender == link.sender && chain[i].signal == link.signal) {
+            repeats++;
+            changed = chain[i].value1 != link.value1 || chain[i].value2 != link.value2;
+        }
+    }
+
+    chain.append(link);
+    chain.last().time = clock.nsecsElapsed();
+
+    emissions++;
+
+    // One report per event is enough
+    if (reported) {
+        return;
+    }
+
+    if (changed) {
+        report("value changed on its way around a cycle");
+    }
+    else if (repeats + 1 > maximumRepeats) {
+        report(QString("signal emitted %1 times in one chain").arg(repeats + 1));
+    }
+    else if (chain.size() > maximumDepth) {
+        report(QString("emissions nested %1 deep").arg(chain.size()));
+    }
+    else if (emissions > maximumEmissions) {
+        report(QString("%1 emissions for one event").arg(emissions));
+    }
+}
+
+void QScientificSignalMonitor::leave()
+{
+    if (chain.isEmpty()) {
+        return;
+    }
+
+    chain.pop_back();
+
+    // Back at the event that started it
+    if (chain.isEmpty()) {
+        emissions = 0;
+        reported = false;
+    }
+}
+
+
+void QScientificSignalMonitor::report(const QString& reason)
+{
+    reported = true;
+    loopCount++;
+
+    QString text = QString("QScientific signal loop: %1").arg(reason);
+
+    qint64 start = chain.first().time;
+
+    for (int i = 0; i < chain.size(); i++) {
+        QObject* sender = chain[i].sender;
+        QString name = sender->objectName().isEmpty() ? sender->metaObject()->className() : sender->objectName();
+
+        QString values = QString::number(chain[i].value1, 'g', 17);
+
+        if (chain[i].pair) {
+            values += ", " + QString::number(chain[i].value2, 'g', 17);
+        }
+
+        text += QString("\n  %1%2::%3(%4) at +%5 ms")
+                .arg(QString(2 * i, ' '))
+                .arg(name)
+                .arg(chain[i].signal)
+                .arg(values)
+                .arg((chain[i].time - start) / 1e6, 0, 'f', 3);
+    }
+
+    qWarning("%s", qPrintable(text));
+
+    emit loopDetected(text);
+}
\ No newline at end of file
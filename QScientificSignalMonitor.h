@@ -0,0 +1,144 @@
+/*=========================================================================
+
+  Name:        QScientificSignalMonitor.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Watches value signals emitted by the QScientific widgets for
+               feedback loops and signal storms.
+
+               Connection cycles, e.g. a QDualValue feeding back into the
+               QDoubleSlider that drives it, only settle because setters
+               ignore unchanged values.  If rounding makes a value differ on
+               its way around, they can ping-pong instead.  Each widget
+               value emission is tracked with a QScientificSignalScope, so the
+               monitor sees the chain of nested emissions caused by one
+               event, and reports it with timings when it
+
+                   - nests deeper than getMaximumDepth(),
+                   - emits one widget signal more than getMaximumRepeats()
+                     times, or emits it again with a different value, or
+                   - emits more than getMaximumEmissions() times for one
+                     event.
+
+               Reports go to qWarning() and loopDetected().  The monitor is
+               enabled by default in debug builds only, and costs one flag
+               check per emission when disabled.
+
+=========================================================================*/
+
+
+#ifndef QSCIENTIFICSIGNALMONITOR_H
+#define QSCIENTIFICSIGNALMONITOR_H
+
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+
+class QScientificSignalMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    // The monitor shared by all widgets
+    static QScientificSignalMonitor* instance();
+
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    // Limits, 16, 2 and 256 by default
+    int getMaximumDepth() const;
+    void setMaximumDepth(int depth);
+    int getMaximumRepeats() const;
+    void setMaximumRepeats(int repeats);
+    int getMaximumEmissions() const;
+    void setMaximumEmissions(int emissions);
+
+    // Number of reports so far
+    int getLoopCount() const;
+
+    // Called by QScientificSignalScope around each emission, with the signal
+    // name and the value or values emitted
+    void enter(QObject* sender, const char* signal, double value);
+    void enter(QObject* sender, const char* signal, double value1, double value2);
+    void leave();
+
+signals:
+    // The offending chain, one emission per line
+    void loopDetected(const QString& report);
+
+protected:
+    QScientificSignalMonitor(QObject* parent = 0);
+
+    static bool enabled;
+
+    // One emission in the current chain
+    struct Link {
+        QObject* sender;
+        const char* signal;
+        bool pair;
+        double value1;
+        double value2;
+        qint64 time;
+    };
+
+    // Nested emissions in progress, outermost first
+    QVector<Link> chain;
+
+    // Emissions since the chain was last empty, and whether it was reported
+    int emissions;
+    bool reported;
+
+    // Limits
+    int maximumDepth;
+    int maximumRepeats;
+    int maximumEmissions;
+
+    int loopCount;
+
+    QElapsedTimer clock;
+
+    // Internal methods
+    void enter(const Link& link);
+    void report(const QString& reason);
+};
+
+
+// Marks an emission for the monitor for as long as it is in scope
+class QScientificSignalScope
+{
+public:
+    QScientificSignalScope(QObject* sender, const char* signal, double value)
+        : active(QScientificSignalMonitor::isEnabled())
+    {
+        if (active) {
+            QScientificSignalMonitor::instance()->enter(sender, signal, value);
+        }
+    }
+
+    QScientificSignalScope(QObject* sender, const char* signal, double value1, double value2)
+        : active(QScientificSignalMonitor::isEnabled())
+    {
+        if (active) {
+            QScientificSignalMonitor::instance()->enter(sender, signal, value1, value2);
+        }
+    }
+
+    ~QScientificSignalScope()
+    {
+        if (active) {
+            QScientificSignalMonitor::instance()->leave();
+        }
+    }
+
+private:
+    bool active;
+};
+
+
+#endif
\ No newline at end of file
@@ -13,7 +13,12 @@
 
 #include "QScientificSpinBox.h"
 
+#include <QEvent>
+
 #include <limits>
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 QScientificSpinBox::QScientificSpinBox(QWidget* parent) 
@@ -24,6 +29,9 @@ QScientificSpinBox::QScientificSpinBox(QWidget* parent)
 
     // Set the decimals to the largest possible value
     setDecimals(std::numeric_limits<int>::max());
+
+    // Cache the locale symbols
+    updateLocaleSymbols();
 }
 
 
@@ -35,9 +43,218 @@ void QScientificSpinBox::setPrecision(int precision)
 
 QString QScientificSpinBox::textFromValue(double value) const
 {
-    QString str = locale().toString(value, 'e', precision);
-    if (qAbs(value) >= 1000.0) {
-        str.remove(locale().groupSeparator());
+    if (!qIsFinite(value)) {
+        return locale().toString(value, 'e', precision);
+    }
+
+    int n = format(value);
+
+    // Map to the locale symbols.  The C library may use a different decimal
+    // point depending on LC_NUMERIC, so treat anything unexpected as one.
+    QString str;
+    str.resize(n);
+
+    QChar* out = str.data();
+
+    for (int i = 0; i < n; i++) {
+        char c = buffer[i];
+
+        if (c >= '0' && c <= '9') {
+            out[i] = QChar(zeroDigit.unicode() + (c - '0'));
+        }
+        else if (c == '-') {
+            out[i] = negativeSign;
+        }
+        else if (c == '+') {
+            out[i] = positiveSign;
+        }
+        else if (c == 'e') {
+            out[i] = exponential;
+        }
+        else {
+            out[i] = decimalPoint;
+        }
     }
+
     return str;
 }
+
+double QScientificSpinBox::valueFromText(const QString& text) const
+{
+    double value;
+
+    if (parse(text, value) != QValidator::Acceptable) {
+        return QDoubleSpinBox::valueFromText(text);
+    }
+
+    return value;
+}
+
+QValidator::State QScientificSpinBox::validate(QString& input, int& pos) const
+{
+    double value;
+
+    QValidator::State state = parse(input, value);
+
+    if (state == QValidator::Acceptable && (value < minimum() || value > maximum())) {
+        return QValidator::Intermediate;
+    }
+
+    return state;
+}
+
+
+void QScientificSpinBox::changeEvent(QEvent* event)
+{
+    QDoubleSpinBox::changeEvent(event);
+
+    if (event->type() == QEvent::LocaleChange) {
+        updateLocaleSymbols();
+    }
+}
+
+
+void QScientificSpinBox::updateLocaleSymbols()
+{
+    QLocale l = locale();
+
+    decimalPoint = l.decimalPoint();
+    exponential = l.exponential();
+    negativeSign = l.negativeSign();
+    positiveSign = l.positiveSign();
+    zeroDigit = l.zeroDigit();
+}
+
+
+int QScientificSpinBox::format(double value) const
+{
+    int n;
+
+    if (precision >= 0) {
+        n = qsnprintf(buffer, sizeof(buffer), "%.*e", qMin(precision, 40), value);
+    }
+    else {
+        // Find the shortest precision that reads back as the same value
+        for (int p = 0; p <= 17; p++) {
+            n = qsnprintf(buffer, sizeof(buffer), "%.*e", p, value);
+
+            if (strtod(buffer, 0) == value) {
+                break;
+            }
+        }
+    }
+
+    // Some C libraries use three exponent digits, so trim to at least two like QLocale
+    char* e = strchr(buffer, 'e');
+
+    if (e && n - (e - buffer) > 4 && e[2] == '0') {
+        memmove(e + 2, e + 3, n - (e + 3 - buffer) + 1);
+        n--;
+    }
+
+    return n;
+}
+
+
+QValidator::State QScientificSpinBox::parse(const QString& text, double& value) const
+{
+    // Skip prefix, suffix, and surrounding spaces
+    int begin = 0;
+    int end = text.size();
+
+    if (!prefix().isEmpty() && text.startsWith(prefix())) {
+        begin += prefix().size();
+    }
+
+    if (!suffix().isEmpty() && text.endsWith(suffix())) {
+        end -= suffix().size();
+    }
+
+    const QChar* s = text.constData();
+
+    while (begin < end && s[begin].isSpace()) {
+        begin++;
+    }
+
+    while (end > begin && s[end - 1].isSpace()) {
+        end--;
+    }
+
+    if (begin >= end) {
+        return QValidator::Intermediate;
+    }
+
+    // Copy to the buffer as C-locale text, checking the syntax on the way
+    char point = localeconv()->decimal_point[0];
+
+    bool mantissaDigits = false;
+    bool hasPoint = false;
+    bool hasExponent = false;
+    bool exponentDigits = false;
+
+    int n = 0;
+
+    for (int i = begin; i < end; i++) {
+        if (n >= (int)sizeof(buffer) - 1) {
+            return QValidator::Invalid;
+        }
+
+        QChar c = s[i];
+
+        int digit = c.unicode() - zeroDigit.unicode();
+
+        if (digit < 0 || digit > 9) {
+            digit = c.unicode() - '0';
+        }
+
+        if (digit >= 0 && digit <= 9) {
+            buffer[n++] = '0' + digit;
+
+            if (hasExponent) {
+                exponentDigits = true;
+            }
+            else {
+                mantissaDigits = true;
+            }
+        }
+        else if (c == negativeSign || c == positiveSign || c == QLatin1Char('-') || c == QLatin1Char('+')) {
+            // Signs are only allowed at the start of the mantissa or exponent
+            if (n > 0 && !(hasExponent && buffer[n - 1] == 'e')) {
+                return QValidator::Invalid;
+            }
+
+            buffer[n++] = c == negativeSign || c == QLatin1Char('-') ? '-' : '+';
+        }
+        else if (c == decimalPoint) {
+            if (hasPoint || hasExponent) {
+                return QValidator::Invalid;
+            }
+
+            hasPoint = true;
+
+            buffer[n++] = point;
+        }
+        else if (c == exponential || c == QLatin1Char('e') || c == QLatin1Char('E')) {
+            if (hasExponent || !mantissaDigits) {
+                return QValidator::Invalid;
+            }
+
+            hasExponent = true;
+
+            buffer[n++] = 'e';
+        }
+        else {
+            return QValidator::Invalid;
+        }
+    }
+
+    if (!mantissaDigits || (hasExponent && !exponentDigits)) {
+        return QValidator::Intermediate;
+    }
+
+    buffer[n] = '\0';
+
+    value = strtod(buffer, 0);
+
+    return QValidator::Acceptable;
+}
@@ -29,14 +29,40 @@ public:
     // The reason for this is that it is basically impossible to change the internal 
     // rounding behavior of QDoubleSpinBox without completely rewriting it, due to 
     // the inaccesiblity of QAbstractSpinBoxPrivate and some functions not being virtual.
+    // A negative precision displays the shortest text that reads back as the same value.
     void setPrecision(int precision);
 
-    // Reimplement textFromValue()
+    // Reimplement textFromValue(), valueFromText(), and validate() with a formatter
+    // and parser that use cached locale symbols and a reusable buffer, since these
+    // are called at mouse-event rate when the spin box is linked to a slider
     virtual QString textFromValue(double value) const;
+    virtual double valueFromText(const QString& text) const;
+    virtual QValidator::State validate(QString& input, int& pos) const;
 
 protected:
     // Number of digits displayed after the decimal point
     int precision;
+
+    // Cached locale symbols
+    QChar decimalPoint;
+    QChar exponential;
+    QChar negativeSign;
+    QChar positiveSign;
+    QChar zeroDigit;
+
+    // Buffer reused for formatting and parsing
+    mutable char buffer[64];
+
+    // Internal methods
+    virtual void changeEvent(QEvent* event);
+
+    void updateLocaleSymbols();
+
+    // Formats the value into the buffer, returning the length
+    int format(double value) const;
+
+    // Parses scientific notation, setting value if the text is a complete number
+    QValidator::State parse(const QString& text, double& value) const;
 };
 
 
@@ -0,0 +1,320 @@
+/*=========================================================================
+
+  Name:        QScientificStatePublisher.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Publishes the state of a set of QScientific widgets to a
+               POSIX shared-memory segment, so another local process can
+               read it without a syscall per update.
+
+=========================================================================*/
+
+
+#include "QScientificStatePublisher.h"
+
+#include "QDualValue.h"
+#include "QExploratorySlider.h"
+#include "QNonlinearSlider.h"
+#include "QPowerSlider.h"
+
+#include <string.h>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+QScientificStatePublisher::QScientificStatePublisher(const QString& name, int lookupTableSize, QObject* parent)
+    : QObject(parent), name(name), lookupTableSize(qMax(lookupTableSize, 0))
+{
+    // Keep records 8-byte aligned
+    recordSize = sizeof(QScientificSharedRecord) + this->lookupTableSize * sizeof(float);
+    recordSize = (recordSize + 7) & ~7;
+
+    size = 0;
+
+    fd = -1;
+    memory = 0;
+}
+
+QScientificStatePublisher::~QScientificStatePublisher()
+{
+    stop();
+}
+
+
+void QScientificStatePublisher::addWidget(QNonlinearSlider* slider)
+{
+    connect(slider, SIGNAL(valueChanged(double)), this, SLOT(widgetChanged()));
+    connect(slider, SIGNAL(rangeChanged(double, double)), this, SLOT(widgetChanged()));
+    connect(slider, SIGNAL(curveChanged()), this, SLOT(curveChanged()));
+
+    addWidget(static_cast<QWidget*>(slider));
+}
+
+void QScientificStatePublisher::addWidget(QDualValue* dualValue)
+{
+    connect(dualValue, SIGNAL(value1Changed(double)), this, SLOT(widgetChanged()));
+    connect(dualValue, SIGNAL(value2Changed(double)), this, SLOT(widgetChanged()));
+    connect(dualValue, SIGNAL(value1RangeChanged(double, double)), this, SLOT(widgetChanged()));
+    connect(dualValue, SIGNAL(value2RangeChanged(double, double)), this, SLOT(widgetChanged()));
+
+    addWidget(static_cast<QWidget*>(dualValue));
+}
+
+void QScientificStatePublisher::addWidget(QWidget* widget)
+{
+    connect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(widgetDestroyed(QObject*)));
+
+    recordIndices.insert(widget, widgets.size());
+    widgets.append(widget);
+
+    // The segment size depends on the number of records
+    if (isActive()) {
+        stop();
+        start();
+    }
+}
+
+
+bool QScientificStatePublisher::start()
+{
+#ifdef Q_OS_UNIX
+    if (isActive()) {
+        return true;
+    }
+
+    QByteArray path = name.toLocal8Bit();
+
+    fd = shm_open(path.constData(), O_CREAT | O_RDWR, 0644);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    size = sizeof(QScientificSharedHeader) + (size_t)widgets.size() * recordSize;
+
+    if (ftruncate(fd, size) != 0) {
+        stop();
+
+        return false;
+    }
+
+    void* p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (p == MAP_FAILED) {
+        stop();
+
+        return false;
+    }
+
+    memory = static_cast<char*>(p);
+
+    // Fill in the header
+    QScientificSharedHeader* h = header();
+    h->magic = Magic;
+    h->version = Version;
+    h->sequence = 0;
+    h->recordCount = widgets.size();
+    h->recordSize = recordSize;
+    h->lookupTableSize = lookupTableSize;
+
+    publish();
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void QScientificStatePublisher::stop()
+{
+#ifdef Q_OS_UNIX
+    if (memory) {
+        // Readers still mapping this segment see it is no longer current
+        beginWrite();
+        header()->magic = 0;
+        endWrite();
+
+        munmap(memory, size);
+        memory = 0;
+    }
+
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+
+        shm_unlink(name.toLocal8Bit().constData());
+    }
+
+    size = 0;
+#endif
+}
+
+bool QScientificStatePublisher::isActive() const
+{
+    return memory != 0;
+}
+
+
+void QScientificStatePublisher::publish()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    beginWrite();
+
+    for (int i = 0; i < widgets.size(); i++) {
+        writeRecord(i, true);
+    }
+
+    endWrite();
+}
+
+
+void QScientificStatePublisher::widgetChanged()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    QHash<QObject*, int>::const_iterator it = recordIndices.find(sender());
+
+    if (it == recordIndices.end()) {
+        return;
+    }
+
+    beginWrite();
+    writeRecord(it.value());
+    endWrite();
+}
+
+void QScientificStatePublisher::curveChanged()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    QHash<QObject*, int>::const_iterator it = recordIndices.find(sender());
+
+    if (it == recordIndices.end()) {
+        return;
+    }
+
+    beginWrite();
+    writeRecord(it.value(), true);
+    endWrite();
+}
+
+void QScientificStatePublisher::widgetDestroyed(QObject* object)
+{
+    QHash<QObject*, int>::iterator it = recordIndices.find(object);
+
+    if (it == recordIndices.end()) {
+        return;
+    }
+
+    int index = it.value();
+    recordIndices.erase(it);
+
+    // Keep the record, but mark it as empty
+    if (isActive()) {
+        beginWrite();
+        record(index)->type = QScientificSharedRecord::None;
+        endWrite();
+    }
+}
+
+
+QScientificSharedHeader* QScientificStatePublisher::header() const
+{
+    return reinterpret_cast<QScientificSharedHeader*>(memory);
+}
+
+QScientificSharedRecord* QScientificStatePublisher::record(int index) const
+{
+    return reinterpret_cast<QScientificSharedRecord*>(memory + sizeof(QScientificSharedHeader) + (size_t)index * recordSize);
+}
+
+
+void QScientificStatePublisher::beginWrite()
+{
+#ifdef Q_OS_UNIX
+    // Odd sequence while writing.  The increment is a full barrier, which
+    // keeps the record writes from being reordered before it.
+    __sync_fetch_and_add(&header()->sequence, 1);
+#endif
+}
+
+void QScientificStatePublisher::endWrite()
+{
+#ifdef Q_OS_UNIX
+    // Even again, after all record writes
+    __sync_fetch_and_add(&header()->sequence, 1);
+#endif
+}
+
+
+void QScientificStatePublisher::writeRecord(int index, bool writeLookupTable)
+{
+    QScientificSharedRecord* r = record(index);
+    float* table = reinterpret_cast<float*>(r + 1);
+
+    QWidget* widget = widgets[index];
+
+    if (!widget) {
+        r->type = QScientificSharedRecord::None;
+
+        return;
+    }
+
+    memset(r, 0, sizeof(QScientificSharedRecord));
+    qstrncpy(r->name, widget->objectName().toUtf8().constData(), sizeof(r->name));
+
+    if (QNonlinearSlider* slider = qobject_cast<QNonlinearSlider*>(widget)) {
+        r->type = QScientificSharedRecord::Slider;
+
+        r->value1 = slider->getValue();
+        r->minimum1 = slider->getMinimum();
+        r->maximum1 = slider->getMaximum();
+
+        r->exponent = 1.0;
+        r->pivotValue = 0.5;
+
+        if (QPowerSlider* power = qobject_cast<QPowerSlider*>(slider)) {
+            r->exponent = power->getExponent();
+        }
+        else if (QExploratorySlider* exploratory = qobject_cast<QExploratorySlider*>(slider)) {
+            r->exponent = exploratory->getExponent();
+            r->pivotValue = exploratory->getPivotValue();
+        }
+
+        if (writeLookupTable) {
+            slider->getLookupTable(table, lookupTableSize);
+        }
+    }
+    else if (QDualValue* dualValue = qobject_cast<QDualValue*>(widget)) {
+        r->type = QScientificSharedRecord::DualValue;
+
+        r->value1 = dualValue->getValue1();
+        r->minimum1 = dualValue->getValue1Minimum();
+        r->maximum1 = dualValue->getValue1Maximum();
+
+        r->value2 = dualValue->getValue2();
+        r->minimum2 = dualValue->getValue2Minimum();
+        r->maximum2 = dualValue->getValue2Maximum();
+
+        r->exponent = 1.0;
+        r->pivotValue = 0.5;
+
+        if (writeLookupTable) {
+            memset(table, 0, lookupTableSize * sizeof(float));
+        }
+    }
+}
\ No newline at end of file
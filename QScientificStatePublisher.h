@@ -0,0 +1,146 @@
+/*=========================================================================
+
+  Name:        QScientificStatePublisher.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Publishes the state of a set of QScientific widgets to a
+               POSIX shared-memory segment, so another local process can
+               read it without a syscall per update.
+
+               The segment holds a QScientificSharedHeader followed by
+               recordCount records of recordSize bytes, each a
+               QScientificSharedRecord followed by lookupTableSize floats
+               holding the normalized curve of a slider.
+
+               The header sequence counter is odd while the publisher is
+               writing.  A reader copies what it needs, and retries if the
+               counter was odd or changed while copying.
+
+               When the publisher stops, or recreates the segment because
+               a widget was added, the magic number of the old segment is
+               cleared with the counter bumped.  A reader that finds it
+               cleared should map the segment again by name.
+
+=========================================================================*/
+
+
+#ifndef QSCIENTIFICSTATEPUBLISHER_H
+#define QSCIENTIFICSTATEPUBLISHER_H
+
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QString>
+
+class QDualValue;
+class QNonlinearSlider;
+class QWidget;
+
+
+// Shared-memory layout
+struct QScientificSharedHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 sequence;
+    quint32 recordCount;
+    quint32 recordSize;
+    quint32 lookupTableSize;
+};
+
+struct QScientificSharedRecord {
+    enum RecordType {
+        None,
+        Slider,
+        DualValue
+    };
+
+    // Widget object name, null terminated
+    char name[64];
+
+    quint32 type;
+    quint32 reserved;
+
+    // Value 1 is the slider value
+    double value1;
+    double minimum1;
+    double maximum1;
+
+    double value2;
+    double minimum2;
+    double maximum2;
+
+    // Exponent and pivot, if the slider has them
+    double exponent;
+    double pivotValue;
+};
+
+
+class QScientificStatePublisher : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Name of the segment, e.g. "/myapp-widgets"
+    QScientificStatePublisher(const QString& name, int lookupTableSize = 256, QObject* parent = 0);
+    virtual ~QScientificStatePublisher();
+
+    static const quint32 Magic = 0x49435351;   // "QSCI"
+    static const quint32 Version = 1;
+
+    // Widgets added while publishing cause the segment to be recreated
+    void addWidget(QNonlinearSlider* slider);
+    void addWidget(QDualValue* dualValue);
+
+    // Create the segment and publish the current state
+    bool start();
+
+    // Remove the segment
+    void stop();
+
+    bool isActive() const;
+
+public slots:
+    // Publish the state of all widgets
+    void publish();
+
+protected slots:
+    void widgetChanged();
+    void curveChanged();
+    void widgetDestroyed(QObject* object);
+
+protected:
+    // Segment name and size
+    QString name;
+    int lookupTableSize;
+    int recordSize;
+    size_t size;
+
+    // Segment handle and mapping
+    int fd;
+    char* memory;
+
+    // Widgets, in record order
+    QList<QPointer<QWidget> > widgets;
+    QHash<QObject*, int> recordIndices;
+
+    // Internal methods
+    void addWidget(QWidget* widget);
+
+    QScientificSharedHeader* header() const;
+    QScientificSharedRecord* record(int index) const;
+
+    void beginWrite();
+    void endWrite();
+
+    // Lookup tables only depend on the curve, so they are left as they are
+    // in the segment unless asked for
+    void writeRecord(int index, bool writeLookupTable = false);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,384 @@
+/*=========================================================================
+
+  Name:        QSplineSlider.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A widget that enables controlling the output of a slider
+               via a monotone cubic spline through user-editable control
+               points.
+
+=========================================================================*/
+
+
+#include "QSplineSlider.h"
+
+#include "QScientificRepaintScheduler.h"
+
+#include <QtCore/qmath.h>
+#include <QMouseEvent>
+#include <QPainter>
+
+
+QSplineSlider::QSplineSlider(QWidget* parent)
+    : QMappedSlider<QSplineMapping>(parent)
+{
+    // No interaction to start with
+    action = QSplineSliderNoAction;
+    activePoint = -1;
+
+    // Control points may be queued to another thread
+    qRegisterMetaType<QVector<QPointF> >("QVector<QPointF>");
+
+    // Appearance
+    pointRadius = 2.5;
+}
+
+
+QVector<QPointF> QSplineSlider::getControlPoints() const
+{
+    return mapping.getControlPoints();
+}
+
+
+void QSplineSlider::setControlPoints(const QVector<QPointF>& points)
+{
+    QVector<QPointF> old = mapping.getControlPoints();
+
+    if (!mapping.setControlPoints(points) || mapping.getControlPoints() == old) {
+        return;
+    }
+
+    // Curve and handle need updating
+    invalidateCurve();
+
+    // Emit the control points as a signal
+    emit controlPointsChanged(mapping.getControlPoints());
+    emit curveChanged();
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+void QSplineSlider::addControlPoint(const QPointF& point)
+{
+    QVector<QPointF> points = mapping.getControlPoints();
+
+    // Keep points at least a pixel apart, and between their neighbors in y,
+    // as when dragging
+    double gap = 1.0 / qMax(functionWidth(), 1);
+
+    double minY = 0.0;
+    double maxY = 1.0;
+
+    for (int i = 0; i < points.size(); i++) {
+        if (qAbs(points[i].x() - point.x()) < gap) {
+            return;
+        }
+
+        if (points[i].x() < point.x()) {
+            minY = points[i].y();
+        }
+        else {
+            maxY = qMin(maxY, points[i].y());
+        }
+    }
+
+    points.append(QPointF(point.x(), qBound(minY, point.y(), maxY)));
+
+    setControlPoints(points);
+}
+
+void QSplineSlider::clearControlPoints()
+{
+    setControlPoints(QVector<QPointF>());
+}
+
+
+void QSplineSlider::getLookupTable(float* table, int size) const
+{
+    // Positions are sorted, so the mapping steps through the intervals in order
+    for (int i = 0; i < size; i++) {
+        table[i] = size > 1 ? (float)i / (size - 1) : 0.0f;
+    }
+
+    mapping.yFromX(table, table, size);
+}
+
+
+void QSplineSlider::beginTransaction()
+{
+    if (transactionDepth == 0) {
+        transactionControlPoints = mapping.getControlPoints();
+    }
+
+    QNonlinearSlider::beginTransaction();
+}
+
+void QSplineSlider::endTransaction()
+{
+    bool outermost = transactionDepth == 1;
+
+    QNonlinearSlider::endTransaction();
+
+    if (outermost && mapping.getControlPoints() != transactionControlPoints) {
+        emit controlPointsChanged(mapping.getControlPoints());
+        emit curveChanged();
+    }
+}
+
+
+void QSplineSlider::mousePressEvent(QMouseEvent* event)
+{
+    // Only care about left-button presses
+    if (event->button() != Qt::LeftButton) {
+        event->ignore();
+
+        return;
+    }
+
+    // Make sure the handle is up to date
+    ensureGeometry();
+
+    // Intersect with controls
+    action = QSplineSliderNoAction;
+
+    QPointF d = event->pos() - pixelsFromWidget(handle);
+
+    if (qSqrt(d.x() * d.x() + d.y() * d.y()) <= handleRadius) {
+        action = QSplineSliderMoveHandle;
+
+        oldHandlePosition = handle;
+    }
+    else {
+        activePoint = controlPointAt(event->pos());
+
+        if (activePoint >= 0) {
+            action = QSplineSliderMovePoint;
+        }
+    }
+
+    if (action == QSplineSliderNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    setDragging(true);
+
+    // Save mouse position
+    oldMousePosition = event->pos();
+}
+
+
+void QSplineSlider::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    // Only care about left- and right-button presses
+    if (event->button() != Qt::LeftButton &&
+        event->button() != Qt::RightButton) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    switch (event->button()) {
+
+        case Qt::LeftButton:
+
+            // Add a control point here
+            addControlPoint(widgetFromPixels(event->pos()));
+
+            break;
+
+        case Qt::RightButton: {
+
+            // Remove the control point here, or all of them
+            int i = controlPointAt(event->pos());
+
+            if (i >= 0) {
+                QVector<QPointF> points = mapping.getControlPoints();
+                points.remove(i);
+
+                setControlPoints(points);
+            }
+            else {
+                clearControlPoints();
+            }
+
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+void QSplineSlider::mouseReleaseEvent(QMouseEvent* event)
+{
+    // Check action variable
+    if (action == QSplineSliderNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    if (action == QSplineSliderMoveHandle) {
+        emit sliderReleased();
+    }
+
+    // Clear action variables
+    action = QSplineSliderNoAction;
+    activePoint = -1;
+
+    // Back to full quality
+    setDragging(false);
+}
+
+
+void QSplineSlider::mouseMoveEvent(QMouseEvent* event)
+{
+    // Check action variable
+    if (action == QSplineSliderNoAction) {
+        event->ignore();
+
+        return;
+    }
+
+    event->accept();
+
+    // Get the delta between the last event and here
+    QPoint delta = event->pos() - oldMousePosition;
+
+    // Save the mouse position
+    oldMousePosition = event->pos();
+
+    switch (action) {
+
+        case QSplineSliderMoveHandle:
+            // Move handle
+            handle.setX(qBound(0.0, oldHandlePosition.x() + (double)delta.x() / width(), 1.0));
+
+            // Update value
+            setValueFromHandle();
+
+            break;
+
+        case QSplineSliderMovePoint: {
+            QVector<QPointF> points = mapping.getControlPoints();
+
+            if (activePoint < 0 || activePoint >= points.size()) {
+                break;
+            }
+
+            // Keep the point between its neighbors, so it stays the same point
+            // and the curve stays monotone without moving the neighbors
+            bool first = activePoint == 0;
+            bool last = activePoint == points.size() - 1;
+
+            double minX = first ? 0.0 : points[activePoint - 1].x();
+            double maxX = last ? 1.0 : points[activePoint + 1].x();
+            double minY = first ? 0.0 : points[activePoint - 1].y();
+            double maxY = last ? 1.0 : points[activePoint + 1].y();
+            double gap = 1.0 / qMax(functionWidth(), 1);
+
+            QPointF p = widgetFromPixels(event->pos());
+            p.setY(qBound(minY, p.y(), maxY));
+
+            if (maxX - minX > 2.0 * gap) {
+                p.setX(qBound(minX + gap, p.x(), maxX - gap));
+            }
+            else {
+                // No room between the neighbors, so only move in y
+                p.setX(points[activePoint].x());
+            }
+
+            points[activePoint] = p;
+
+            setControlPoints(points);
+
+            // Follow the point, in case the points were reordered
+            int i = mapping.getControlPoints().indexOf(p);
+
+            if (i >= 0) {
+                activePoint = i;
+            }
+
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    // Save the widget position
+    oldHandlePosition = handle;
+
+    // Repaint
+    QScientificRepaintScheduler::schedule(this);
+}
+
+
+void QSplineSlider::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+
+
+    // Positions and sizes may need to change
+    ensureGeometry();
+
+
+    // Draw
+    QNonlinearSliderPainter sliderPainter = getSliderPainter();
+    sliderPainter.setPivotRadius(pointRadius);
+
+    sliderPainter.drawBorder(&painter, palette());
+    drawTicks(&painter);
+    sliderPainter.drawCurve(&painter, palette(), curve);
+
+    const QVector<QPointF>& points = mapping.getControlPoints();
+
+    for (int i = 0; i < points.size(); i++) {
+        sliderPainter.drawPivot(&painter, palette(), points[i].x(), points[i].y());
+    }
+
+    sliderPainter.drawValue(&painter, palette(), handle.x(), widgetYFromValue(value));
+    sliderPainter.drawHandle(&painter, palette(), handle.x());
+
+    drawCoverage(&painter);
+}
+
+
+int QSplineSlider::controlPointAt(const QPoint& p) const
+{
+    const QVector<QPointF>& points = mapping.getControlPoints();
+
+    int closest = -1;
+    double closestDistance = handleRadius;
+
+    for (int i = 0; i < points.size(); i++) {
+        QPointF d = p - pixelsFromWidget(points[i]);
+        double distance = qSqrt(d.x() * d.x() + d.y() * d.y());
+
+        if (distance <= closestDistance) {
+            closest = i;
+            closestDistance = distance;
+        }
+    }
+
+    return closest;
+}
+
+QPointF QSplineSlider::widgetFromPixels(const QPoint& p) const
+{
+    return QPointF(qBound(0.0, (double)(p.x() - borderX) / functionWidth(), 1.0),
+                   qBound(0.0, (double)(height() - borderY - p.y()) / functionHeight(), 1.0));
+}
\ No newline at end of file
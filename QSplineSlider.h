@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Name:        QSplineSlider.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A widget that enables controlling the output of a slider
+               via a monotone cubic spline through user-editable control
+               points.
+
+=========================================================================*/
+
+
+#ifndef QSPLINESLIDER_H
+#define QSPLINESLIDER_H
+
+
+#include "QMappedSlider.h"
+#include "QScientificMetaTypes.h"
+
+#include <QVector>
+
+
+class QSplineSlider : public QMappedSlider<QSplineMapping>
+{
+    Q_OBJECT
+
+public:
+    QSplineSlider(QWidget* parent = 0);
+
+    // Interior control points, in normalized coordinates.  Points that would
+    // make the curve decrease are ignored, as in QSplineMapping.
+    QVector<QPointF> getControlPoints() const;
+    void setControlPoints(const QVector<QPointF>& points);
+
+    virtual void getLookupTable(float* table, int size) const;
+
+    virtual void beginTransaction();
+    virtual void endTransaction();
+
+public slots:
+    void addControlPoint(const QPointF& point);
+    void clearControlPoints();
+
+signals:
+    void controlPointsChanged(const QVector<QPointF>& points);
+
+protected:
+    // Size of drawn control points, in pixels
+    double pointRadius;
+
+    // Interaction states
+    enum QSplineSliderAction {
+        QSplineSliderNoAction,
+        QSplineSliderMoveHandle,
+        QSplineSliderMovePoint
+    };
+    QSplineSliderAction action;
+
+    // Control point being moved
+    int activePoint;
+
+    // Control points before the outermost beginTransaction()
+    QVector<QPointF> transactionControlPoints;
+
+    // Internal methods
+    virtual void paintEvent(QPaintEvent* event);
+
+    void mousePressEvent(QMouseEvent* event);
+    void mouseDoubleClickEvent(QMouseEvent* event);
+    void mouseReleaseEvent(QMouseEvent* event);
+    void mouseMoveEvent(QMouseEvent* event);
+
+    // Returns the control point under the pixel position, or -1
+    int controlPointAt(const QPoint& p) const;
+
+    QPointF widgetFromPixels(const QPoint& p) const;
+};
+
+
+#endif
\ No newline at end of file
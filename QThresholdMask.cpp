@@ -0,0 +1,272 @@
+/*=========================================================================
+
+  Name:        QThresholdMask.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A per-sample bitmask of which samples are above a threshold,
+               updated incrementally as the threshold is dragged.
+
+=========================================================================*/
+
+
+#include "QThresholdMask.h"
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+
+// Below this many samples a change is applied on the calling thread
+static const qint64 parallelThreshold = 1 << 16;
+
+
+// One thread's share of the changed samples, and where to sort them by
+// the range of mask words they fall in
+struct QThresholdMaskSlice {
+    const quint32* samples;
+    qint64 count;
+    quint32 wordsPerRange;
+    qint64* offsets;
+    quint32* partitioned;
+};
+
+static void countSlice(QThresholdMaskSlice& slice)
+{
+    for (qint64 i = 0; i < slice.count; i++) {
+        slice.offsets[(slice.samples[i] >> 5) / slice.wordsPerRange]++;
+    }
+}
+
+static void partitionSlice(QThresholdMaskSlice& slice)
+{
+    for (qint64 i = 0; i < slice.count; i++) {
+        quint32 s = slice.samples[i];
+
+        slice.partitioned[slice.offsets[(s >> 5) / slice.wordsPerRange]++] = s;
+    }
+}
+
+
+// Changed samples that all fall in one range of mask words
+struct QThresholdMaskRun {
+    const quint32* samples;
+    qint64 count;
+    quint32* mask;
+    bool above;
+};
+
+static void setRun(QThresholdMaskRun& run)
+{
+    if (run.above) {
+        for (qint64 i = 0; i < run.count; i++) {
+            quint32 s = run.samples[i];
+
+            run.mask[s >> 5] |= 1u << (s & 31);
+        }
+    }
+    else {
+        for (qint64 i = 0; i < run.count; i++) {
+            quint32 s = run.samples[i];
+
+            run.mask[s >> 5] &= ~(1u << (s & 31));
+        }
+    }
+}
+
+
+QThresholdMask::QThresholdMask(QObject* parent)
+    : QObject(parent)
+{
+    sampleCount = 0;
+
+    threshold = 0.0;
+
+    changedFirst = 0;
+    changedCount = 0;
+    changedAbove = false;
+}
+
+
+void QThresholdMask::clear()
+{
+    index.clear();
+    sampleCount = 0;
+
+    std::vector<quint32>().swap(mask);
+    std::vector<quint32>().swap(partitioned);
+
+    changedFirst = 0;
+    changedCount = 0;
+}
+
+
+qint64 QThresholdMask::size() const
+{
+    return sampleCount;
+}
+
+const QDataIndex& QThresholdMask::getDataIndex() const
+{
+    return index;
+}
+
+
+double QThresholdMask::getThreshold() const
+{
+    return threshold;
+}
+
+
+const std::vector<quint32>& QThresholdMask::getMask() const
+{
+    return mask;
+}
+
+bool QThresholdMask::isAbove(qint64 i) const
+{
+    return (mask[i >> 5] >> (i & 31)) & 1;
+}
+
+
+qint64 QThresholdMask::countAbove() const
+{
+    return index.countAbove(threshold);
+}
+
+
+const quint32* QThresholdMask::getChangedSamples() const
+{
+    return changedCount > 0 ? &index.getPermutation()[changedFirst] : 0;
+}
+
+qint64 QThresholdMask::getChangedCount() const
+{
+    return changedCount;
+}
+
+bool QThresholdMask::getChangedAbove() const
+{
+    return changedAbove;
+}
+
+
+void QThresholdMask::setThreshold(double value)
+{
+    // NaN would not order against the sorted data
+    if (value != value || value == threshold) {
+        return;
+    }
+
+    const std::vector<double>& sorted = index.getSortedData();
+
+    // Samples in (min, max] of the two thresholds flip
+    qint64 first = std::upper_bound(sorted.begin(), sorted.end(), qMin(value, threshold)) - sorted.begin();
+    qint64 last = std::upper_bound(sorted.begin(), sorted.end(), qMax(value, threshold)) - sorted.begin();
+
+    bool above = value < threshold;
+
+    threshold = value;
+
+    if (first == last) {
+        return;
+    }
+
+    setBits(first, last - first, above);
+
+    emit maskChanged();
+}
+
+
+void QThresholdMask::buildMask()
+{
+    mask.assign((sampleCount + 31) / 32, 0);
+
+    const std::vector<double>& sorted = index.getSortedData();
+
+    qint64 first = std::upper_bound(sorted.begin(), sorted.end(), threshold) - sorted.begin();
+
+    setBits(first, sorted.size() - first, true);
+
+    emit maskChanged();
+}
+
+void QThresholdMask::setBits(qint64 first, qint64 count, bool above)
+{
+    changedFirst = first;
+    changedCount = count;
+    changedAbove = above;
+
+    if (count == 0) {
+        return;
+    }
+
+    const quint32* samples = &index.getPermutation()[first];
+
+    int threads = count < parallelThreshold ? 1 : qMax(QThread::idealThreadCount(), 1);
+
+    if (threads == 1) {
+        QThresholdMaskRun run;
+        run.samples = samples;
+        run.count = count;
+        run.mask = &mask[0];
+        run.above = above;
+
+        setRun(run);
+
+        return;
+    }
+
+    // Samples are scattered through the mask, so each thread first sorts
+    // its share of them by the range of mask words they fall in
+    quint32 wordsPerRange = (mask.size() + threads - 1) / threads;
+
+    partitioned.resize(count);
+
+    QVector<qint64> offsets(threads * threads, 0);
+    QVector<QThresholdMaskSlice> slices;
+
+    for (int i = 0; i < threads; i++) {
+        QThresholdMaskSlice slice;
+        slice.samples = samples + count * i / threads;
+        slice.count = count * (i + 1) / threads - count * i / threads;
+        slice.wordsPerRange = wordsPerRange;
+        slice.offsets = &offsets[i * threads];
+        slice.partitioned = &partitioned[0];
+
+        slices.append(slice);
+    }
+
+    QtConcurrent::blockingMap(slices, countSlice);
+
+    // Lay the ranges out one after another, each slice's part in order
+    QVector<QThresholdMaskRun> runs;
+    qint64 offset = 0;
+
+    for (int r = 0; r < threads; r++) {
+        QThresholdMaskRun run;
+        run.samples = &partitioned[0] + offset;
+        run.mask = &mask[0];
+        run.above = above;
+
+        for (int i = 0; i < threads; i++) {
+            qint64 n = offsets[i * threads + r];
+
+            offsets[i * threads + r] = offset;
+            offset += n;
+        }
+
+        run.count = &partitioned[0] + offset - run.samples;
+
+        runs.append(run);
+    }
+
+    QtConcurrent::blockingMap(slices, partitionSlice);
+
+    // Then each thread writes one range of words, which no other touches
+    QtConcurrent::blockingMap(runs, setRun);
+}
\ No newline at end of file
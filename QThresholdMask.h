@@ -0,0 +1,113 @@
+/*=========================================================================
+
+  Name:        QThresholdMask.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: A per-sample bitmask of which samples are above a threshold,
+               e.g. for an isosurface preview, kept up to date as the
+               threshold is dragged.
+
+               The data is sorted once, keeping the permutation back to
+               sample indices.  When the threshold moves, only the samples
+               between the old and new thresholds flip, and they are a
+               contiguous run of the permutation, so only that run is
+               updated.  A large run is split between threads, which sort
+               their samples by range of mask words, and then each thread
+               sets the samples in its own range of words.  The run is also
+               available as the list of changed samples, so a renderer can
+               update incrementally.
+
+               Connect a slider's valueChanged(double) to setThreshold().
+
+=========================================================================*/
+
+
+#ifndef QTHRESHOLDMASK_H
+#define QTHRESHOLDMASK_H
+
+
+#include "QDataIndex.h"
+
+#include <QObject>
+
+#include <vector>
+
+
+class QThresholdMask : public QObject
+{
+    Q_OBJECT
+
+public:
+    QThresholdMask(QObject* parent = 0);
+
+    // Copies and sorts the data, and builds the mask for the current
+    // threshold.  NaN samples are never above.
+    template <class T>
+    void setData(const T* data, qint64 n)
+    {
+        index.setData(data, n, true);
+
+        sampleCount = n;
+
+        buildMask();
+    }
+
+    void clear();
+
+    // Number of samples, including NaNs
+    qint64 size() const;
+
+    // The sorted data, e.g. for a slider's setDataIndex()
+    const QDataIndex& getDataIndex() const;
+
+    double getThreshold() const;
+
+    // One bit per sample, least significant first, set if the sample is
+    // greater than the threshold
+    const std::vector<quint32>& getMask() const;
+    bool isAbove(qint64 i) const;
+
+    // Number of samples above the threshold
+    qint64 countAbove() const;
+
+    // Samples that flipped on the last change, and whether they are now
+    // above the threshold.  Valid until the next change.
+    const quint32* getChangedSamples() const;
+    qint64 getChangedCount() const;
+    bool getChangedAbove() const;
+
+public slots:
+    // A NaN threshold is ignored
+    void setThreshold(double value);
+
+signals:
+    // Emitted when samples flip
+    void maskChanged();
+
+protected:
+    QDataIndex index;
+    qint64 sampleCount;
+
+    double threshold;
+
+    std::vector<quint32> mask;
+
+    // Changed samples sorted by the thread that sets them, reused between
+    // changes
+    std::vector<quint32> partitioned;
+
+    // Run of the permutation changed last
+    qint64 changedFirst;
+    qint64 changedCount;
+    bool changedAbove;
+
+    // Internal methods
+    void buildMask();
+    void setBits(qint64 first, qint64 count, bool above);
+};
+
+
+#endif
\ No newline at end of file
@@ -0,0 +1,144 @@
+/*=========================================================================
+
+  Name:        QCurveCoefficientsTest.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Checks that QCurveCoefficients::evaluate(), the reference
+               for the shader, matches valueFromWidgetX() of the power and
+               exploratory sliders it was taken from, over a sweep of
+               exponents, pivot values and ranges.
+
+               The tolerance is a fraction of the range, as single
+               precision keeps about 7 significant digits of it.  Returns
+               the number of failed configurations.
+
+=========================================================================*/
+
+
+#include "QCurveCoefficients.h"
+#include "QExploratorySlider.h"
+#include "QPowerSlider.h"
+
+#include <QApplication>
+
+#include <stdio.h>
+
+
+// Largest error allowed, as a fraction of the range
+static const double tolerance = 1e-5;
+
+// Slider positions checked for each configuration
+static const int sampleCount = 1000;
+
+
+// Expose the mapping used by the widgets
+class TestPowerSlider : public QPowerSlider
+{
+public:
+    using QPowerSlider::valueFromWidgetX;
+};
+
+class TestExploratorySlider : public QExploratorySlider
+{
+public:
+    using QExploratorySlider::valueFromWidgetX;
+};
+
+
+// Returns the largest error over [0, 1], as a fraction of the range
+template <class Slider>
+double maximumError(const Slider& slider, const QCurveCoefficients& coefficients, double minimum, double maximum)
+{
+    double error = 0.0;
+
+    for (int i = 0; i <= sampleCount; i++) {
+        double x = (double)i / sampleCount;
+        double e = qAbs(coefficients.evaluate(x) - slider.valueFromWidgetX(x)) / (maximum - minimum);
+
+        // A NaN anywhere fails the configuration
+        if (e != e) {
+            return e;
+        }
+
+        error = qMax(error, e);
+    }
+
+    return error;
+}
+
+
+bool check(const char* name, double exponent, double pivotValue, double minimum, double maximum, double error)
+{
+    bool passed = error <= tolerance;
+
+    if (!passed) {
+        fprintf(stderr, "FAIL %s exponent %g pivot value %g range [%g, %g]: error %g exceeds %g\n",
+                name, exponent, pivotValue, minimum, maximum, error, tolerance);
+    }
+
+    return passed;
+}
+
+
+int main(int argc, char** argv) {
+    QApplication app(argc, argv);
+
+    static const double exponents[] = { 0.1, 0.25, 0.5, 0.8, 1.0, 1.5, 2.0, 4.0, 10.0 };
+    static const double pivotValues[] = { 0.0, 0.05, 0.3, 0.5, 0.9, 1.0 };
+    static const double ranges[][2] = { { 0.0, 1.0 }, { -1000.0, 1000.0 }, { 1e3, 1e6 }, { -1e-3, 1e-3 }, { -5.0, 0.0 } };
+
+    int exponentCount = sizeof(exponents) / sizeof(exponents[0]);
+    int pivotValueCount = sizeof(pivotValues) / sizeof(pivotValues[0]);
+    int rangeCount = sizeof(ranges) / sizeof(ranges[0]);
+
+    TestPowerSlider power;
+    TestExploratorySlider exploratory;
+
+    int checked = 0;
+    int failed = 0;
+    double worst = 0.0;
+
+    for (int r = 0; r < rangeCount; r++) {
+        double minimum = ranges[r][0];
+        double maximum = ranges[r][1];
+
+        power.setRange(minimum, maximum);
+        exploratory.setRange(minimum, maximum);
+
+        for (int i = 0; i < exponentCount; i++) {
+            double e = exponents[i];
+
+            // Power slider
+            power.setExponent(e);
+
+            double error = maximumError(power, power.getCoefficients(), minimum, maximum);
+
+            failed += check("power", e, 0.0, minimum, maximum, error) ? 0 : 1;
+            worst = qMax(worst, error);
+            checked++;
+
+            // Exploratory slider
+            exploratory.setExponent(e);
+
+            for (int j = 0; j < pivotValueCount; j++) {
+                double pv = pivotValues[j];
+
+                exploratory.setPivotValue(pv);
+
+                error = maximumError(exploratory, exploratory.getCoefficients(), minimum, maximum);
+
+                failed += check("exploratory", e, pv, minimum, maximum, error) ? 0 : 1;
+                worst = qMax(worst, error);
+                checked++;
+            }
+        }
+    }
+
+    printf("%d of %d configurations within %g of the range, largest error %g\n",
+           checked - failed, checked, tolerance, worst);
+
+    return failed;
+}
\ No newline at end of file
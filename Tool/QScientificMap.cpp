@@ -0,0 +1,335 @@
+/*=========================================================================
+
+  Name:        QScientificMap.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  Description: Command-line tool that applies a saved power, exploratory,
+               multi-pivot or spline slider curve to a raw volume, using
+               the same mapping classes as the widgets.
+
+               Usage:
+
+                   QScientificMap [options] config.ini input.raw output.raw
+
+               Options:
+
+                   --type uint8|uint16|uint32|float   input sample type,
+                                                      default uint8
+                   --to-value                         see below
+
+               By default each sample is a data value, and the output is
+               the slider position it maps to, as in widgetXFromValue().
+               With --to-value each sample is a slider position, with
+               integer types scaled to [0, 1], and the output is the data
+               value, as in valueFromWidgetX().  Samples are clamped as
+               the sliders do.  The output is always native-endian float.
+
+               The configuration is an INI file:
+
+                   [Slider]
+                   type=power              power, exploratory, multipivot
+                                           or spline
+                   minimum=0
+                   maximum=1
+                   exponent=1
+                   pivotValue=0.5          exploratory only
+                   pivotValues=0.2, 0.7    multipivot only
+                   controlPoints=0.2 0.1, 0.6 0.8
+                                           spline only, x y pairs
+                   accuracy=exact          exact or fast
+
+=========================================================================*/
+
+
+#include "QNonlinearMapping.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSettings>
+#include <QStringList>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <limits>
+#include <stdio.h>
+
+
+// Samples per chunk processed by one thread
+static const qint64 chunkSize = 1 << 20;
+
+
+// Slider parameters
+struct Parameters {
+    double minimum;
+    double maximum;
+
+    bool toValue;
+
+    // Scale from input samples to slider positions, for --to-value
+    double positionScale;
+};
+
+
+// A range of samples to map
+template <class T, class Mapping>
+struct Chunk {
+    const T* input;
+    float* output;
+    qint64 count;
+
+    const Mapping* mapping;
+    const Parameters* parameters;
+};
+
+
+template <class T, class Mapping>
+void mapChunk(Chunk<T, Mapping>& chunk)
+{
+    const Mapping& mapping = *chunk.mapping;
+
+    double minimum = chunk.parameters->minimum;
+    double maximum = chunk.parameters->maximum;
+    double range = maximum - minimum;
+
+    if (chunk.parameters->toValue) {
+        double scale = chunk.parameters->positionScale;
+
+        for (qint64 i = 0; i < chunk.count; i++) {
+            double x = qBound(0.0, chunk.input[i] * scale, 1.0);
+
+            chunk.output[i] = minimum + mapping.yFromX(x) * range;
+        }
+    }
+    else {
+        for (qint64 i = 0; i < chunk.count; i++) {
+            double v = qBound(minimum, (double)chunk.input[i], maximum);
+
+            chunk.output[i] = mapping.xFromY((v - minimum) / range);
+        }
+    }
+}
+
+
+template <class T, class Mapping>
+void mapVolume(const uchar* input, uchar* output, qint64 count, const Mapping& mapping, Parameters parameters)
+{
+    if (std::numeric_limits<T>::is_integer) {
+        parameters.positionScale = 1.0 / std::numeric_limits<T>::max();
+    }
+    else {
+        parameters.positionScale = 1.0;
+    }
+
+    // Split into chunks
+    QVector<Chunk<T, Mapping> > chunks;
+
+    for (qint64 i = 0; i < count; i += chunkSize) {
+        Chunk<T, Mapping> chunk;
+        chunk.input = reinterpret_cast<const T*>(input) + i;
+        chunk.output = reinterpret_cast<float*>(output) + i;
+        chunk.count = qMin(chunkSize, count - i);
+        chunk.mapping = &mapping;
+        chunk.parameters = &parameters;
+
+        chunks.append(chunk);
+    }
+
+    QtConcurrent::blockingMap(chunks, &mapChunk<T, Mapping>);
+}
+
+
+template <class Mapping>
+bool mapVolume(const QString& type, const uchar* input, uchar* output, qint64 count, const Mapping& mapping, const Parameters& parameters)
+{
+    if (type == "uint8") {
+        mapVolume<quint8>(input, output, count, mapping, parameters);
+    }
+    else if (type == "uint16") {
+        mapVolume<quint16>(input, output, count, mapping, parameters);
+    }
+    else if (type == "uint32") {
+        mapVolume<quint32>(input, output, count, mapping, parameters);
+    }
+    else if (type == "float") {
+        mapVolume<float>(input, output, count, mapping, parameters);
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+
+int sampleSize(const QString& type)
+{
+    if (type == "uint8") return 1;
+    if (type == "uint16") return 2;
+    if (type == "uint32") return 4;
+    if (type == "float") return 4;
+
+    return 0;
+}
+
+
+void printUsage()
+{
+    fprintf(stderr, "Usage: QScientificMap [--type uint8|uint16|uint32|float] [--to-value] config.ini input.raw output.raw\n");
+}
+
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    // Parse arguments
+    QStringList arguments = app.arguments();
+    QStringList files;
+
+    QString type = "uint8";
+    bool toValue = false;
+
+    for (int i = 1; i < arguments.size(); i++) {
+        if (arguments[i] == "--type" && i + 1 < arguments.size()) {
+            type = arguments[++i];
+        }
+        else if (arguments[i] == "--to-value") {
+            toValue = true;
+        }
+        else {
+            files.append(arguments[i]);
+        }
+    }
+
+    int size = sampleSize(type);
+
+    if (files.size() != 3 || size == 0) {
+        printUsage();
+
+        return 1;
+    }
+
+
+    // Read the slider configuration
+    QSettings settings(files[0], QSettings::IniFormat);
+
+    if (!QFile::exists(files[0]) || settings.status() != QSettings::NoError) {
+        fprintf(stderr, "Could not read %s\n", qPrintable(files[0]));
+
+        return 1;
+    }
+
+    settings.beginGroup("Slider");
+
+    QString sliderType = settings.value("type", "power").toString();
+
+    double minimum = settings.value("minimum", 0.0).toDouble();
+    double maximum = settings.value("maximum", 1.0).toDouble();
+
+    if (!(qAbs(maximum - minimum) > 0.0)) {
+        fprintf(stderr, "Minimum and maximum must differ\n");
+
+        return 1;
+    }
+
+    double exponent = settings.value("exponent", 1.0).toDouble();
+    double pivotValue = settings.value("pivotValue", 0.5).toDouble();
+
+    QVector<double> pivotValues;
+    QStringList pivotStrings = settings.value("pivotValues").toStringList();
+
+    for (int i = 0; i < pivotStrings.size(); i++) {
+        pivotValues.append(pivotStrings[i].toDouble());
+    }
+
+    QVector<QPointF> controlPoints;
+    QStringList pointStrings = settings.value("controlPoints").toStringList();
+
+    for (int i = 0; i < pointStrings.size(); i++) {
+        QStringList xy = pointStrings[i].split(' ', QString::SkipEmptyParts);
+
+        if (xy.size() == 2) {
+            controlPoints.append(QPointF(xy[0].toDouble(), xy[1].toDouble()));
+        }
+    }
+
+    QPowAccuracy accuracy = settings.value("accuracy", "exact").toString() == "fast" ? QPowFast : QPowExact;
+
+    Parameters parameters;
+    parameters.minimum = qMin(minimum, maximum);
+    parameters.maximum = qMax(minimum, maximum);
+    parameters.toValue = toValue;
+    parameters.positionScale = 1.0;
+
+    if (sliderType != "power" && sliderType != "exploratory" && sliderType != "multipivot" && sliderType != "spline") {
+        fprintf(stderr, "Unknown slider type %s\n", qPrintable(sliderType));
+
+        return 1;
+    }
+
+    QSplineMapping spline;
+
+    if (sliderType == "spline" && !spline.setControlPoints(controlPoints)) {
+        fprintf(stderr, "Control points must not decrease in y\n");
+
+        return 1;
+    }
+
+
+    // Map the input
+    QFile inputFile(files[1]);
+
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "Could not open %s\n", qPrintable(files[1]));
+
+        return 1;
+    }
+
+    qint64 count = inputFile.size() / size;
+
+    if (inputFile.size() % size != 0) {
+        fprintf(stderr, "Warning: ignoring %d trailing bytes\n", (int)(inputFile.size() % size));
+    }
+
+    QFile outputFile(files[2]);
+
+    if (!outputFile.open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+        !outputFile.resize(count * sizeof(float))) {
+        fprintf(stderr, "Could not create %s\n", qPrintable(files[2]));
+
+        return 1;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    uchar* input = inputFile.map(0, count * size);
+    uchar* output = outputFile.map(0, count * sizeof(float));
+
+    if (!input || !output) {
+        fprintf(stderr, "Could not map files\n");
+
+        return 1;
+    }
+
+    if (sliderType == "exploratory") {
+        mapVolume(type, input, output, count, QExploratoryMapping(exponent, pivotValue, accuracy), parameters);
+    }
+    else if (sliderType == "multipivot") {
+        mapVolume(type, input, output, count, QMultiPivotMapping(exponent, pivotValues, accuracy), parameters);
+    }
+    else if (sliderType == "spline") {
+        mapVolume(type, input, output, count, spline, parameters);
+    }
+    else {
+        mapVolume(type, input, output, count, QPowerMapping(exponent, accuracy), parameters);
+    }
+
+    outputFile.unmap(output);
+    inputFile.unmap(input);
+
+    return 0;
+}
\ No newline at end of file